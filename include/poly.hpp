@@ -16,8 +16,11 @@
 
 #ifndef INC_PROPERTIES_HPP_
 #define INC_PROPERTIES_HPP_
+#include "poly/closed_struct.hpp"
 #include "poly/config.hpp"
+#include "poly/dispatch.hpp"
 #include "poly/interface.hpp"
+#include "poly/segmented_vector.hpp"
 #include "poly/storage.hpp"
 #include "poly/struct.hpp"
 
@@ -1,6 +1,7 @@
 #ifndef POLY_ALLOC_HPP
 #define POLY_ALLOC_HPP
 #include "poly/config.hpp"
+#include "poly/pool.hpp"
 
 #include <memory>
 #include <new>
@@ -17,35 +18,69 @@ namespace poly::detail {
 #if __STDC_HOSTED__ == 1
 // in hosted environments, mem_alloc and mem_free are implemented -> heap_storage is available.
 #  ifdef POLY_HEADER_ONLY
+/// allocates from and frees to the system allocator
+struct system_memory {
 #    ifdef POLY_ON_WINDOWS
-/// allocates uninitialized memory with size `size` and alignment `align` using
-/// operator new(size_t,std::align_val_t, std::nothrow_t).
+  /// allocates uninitialized memory with size `size` and alignment `align`
+  /// using _aligned_malloc.
+  /// @returns pointer to allocated memory on success. Returns nullptr if
+  /// allocation failed.
+  [[nodiscard]] static void* allocate(std::size_t size,
+                                      std::size_t align) noexcept {
+    return _aligned_malloc(size, align);
+  }
+
+  /// deallocates memory allocated with allocate().
+  /// @param p pointer returned by allocate(size,align)
+  static void deallocate(void* p) noexcept { _aligned_free(p); }
+#    else
+  /// allocates uninitialized memory with size `size` and alignment `align`
+  /// using aligned_alloc.
+  /// @returns pointer to allocated memory on success. Returns nullptr if
+  /// allocation failed.
+  [[nodiscard]] static void* allocate(std::size_t size,
+                                      std::size_t align) noexcept {
+    using namespace std; // std::aligned_alloc is not available on some
+                         // platforms even in C++17, but ::aligned_alloc
+                         // should be present.
+    // aligned_alloc requires the size to be a multiple of the alignment
+    return aligned_alloc(align, (size + align - 1) / align * align);
+  }
+
+  /// deallocates memory allocated with allocate().
+  /// @param p pointer returned by allocate(size,align)
+  static void deallocate(void* p) noexcept { std::free(p); }
+#    endif
+};
+
+#    if POLY_USE_POOLED_ALLOC
+/// allocates uninitialized memory with size `size` and alignment `align` from
+/// the pool of the calling thread, see pool.
 /// @returns pointer to allocated memory on success. Returns nullptr if
 /// allocation failed.
 [[nodiscard]] inline void* mem_alloc(std::size_t size,
                                      std::size_t align) noexcept {
-  return _aligned_malloc(size, align);
+  return pool<system_memory>::local().allocate(size, align);
 }
 
-/// deallocates memory allocated with me_alloc().
+/// deallocates memory allocated with mem_alloc(). The memory may be freed
+/// from any thread.
 /// @param p pointer returned by mem_alloc(size,align)
-/// @param align must be the same alignment value passed in to mem_alloc().
-inline void mem_free(void* p) noexcept { _aligned_free(p); }
+inline void mem_free(void* p) noexcept {
+  pool<system_memory>::local().deallocate(p);
+}
 #    else
-/// allocates uninitialized memory with size `size` and alignment `align` using
-/// operator new(size_t,std::align_val_t, std::nothrow_t).
+/// allocates uninitialized memory with size `size` and alignment `align`.
 /// @returns pointer to allocated memory on success. Returns nullptr if
 /// allocation failed.
 [[nodiscard]] inline void* mem_alloc(std::size_t size,
                                      std::size_t align) noexcept {
-  using namespace std; // std::aligned_alloc is not available on some platforms
-                       // even in C++17, but ::aligned_alloc should be present.
-  return aligned_alloc(align, size);
+  return system_memory::allocate(size, align);
 }
 
 /// deallocates memory allocated with mem_alloc().
 /// @param p pointer returned by mem_alloc(size,align)
-inline void mem_free(void* p) noexcept { std::free(p); }
+inline void mem_free(void* p) noexcept { system_memory::deallocate(p); }
 #    endif
 #  else
 /// allocates uninitialized memory with size `size` and alignment `align`
@@ -107,5 +142,101 @@ void deallocate(T* p) noexcept(std::is_nothrow_destructible_v<T>) {
   std::destroy_at(p);
   mem_free(p);
 }
+
+template<typename Allocator, typename T>
+using rebind_alloc_t =
+    typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+/// allocates memory for a T with alloc and constructs the T with args.
+///
+/// @note memory allocated with allocate_with() must be freed with
+/// deallocate_with() and an allocator comparing equal to alloc.
+///
+/// @param alloc allocator to allocate the memory with. It is rebound to T.
+/// @param args parameters to construct a T with.
+/// @returns pointer to T if allocation succeeded, nullptr if alloc returned
+/// nullptr.
+template<typename T, typename Allocator, typename... Args>
+[[nodiscard]] T* allocate_with(const Allocator& alloc, Args&&... args) noexcept(
+    std::is_nothrow_constructible_v<T, Args&&...> and
+    noexcept(std::declval<rebind_alloc_t<Allocator, T>&>().allocate(1))) {
+  using traits = std::allocator_traits<rebind_alloc_t<Allocator, T>>;
+  rebind_alloc_t<Allocator, T> a(alloc);
+  T* mem = traits::allocate(a, 1);
+  if (!mem)
+    return nullptr;
+  return poly::detail::construct_at(mem, std::forward<Args>(args)...);
+}
+
+/// destroys the object located at p and frees its memory with alloc.
+///
+/// @param alloc allocator comparing equal to the one p was allocated with.
+/// @param p pointer to T allocated with allocate_with<T>(...)
+template<typename T, typename Allocator>
+void deallocate_with(const Allocator& alloc,
+                     T* p) noexcept(std::is_nothrow_destructible_v<T>) {
+  using traits = std::allocator_traits<rebind_alloc_t<Allocator, T>>;
+  rebind_alloc_t<Allocator, T> a(alloc);
+  std::destroy_at(p);
+  traits::deallocate(a, p, 1);
+}
 } // namespace poly::detail
+
+namespace poly {
+#if __STDC_HOSTED__ == 1 && POLY_USE_POOLED_ALLOC
+#  ifdef POLY_HEADER_ONLY
+/// returns the statistics of the pooled allocator of the calling thread.
+inline pool_statistics pool_stats() noexcept {
+  return detail::pool<detail::system_memory>::local().statistics();
+}
+
+/// returns the memory cached by the pooled allocator of the calling thread to
+/// the system.
+inline void release_pool() noexcept {
+  detail::pool<detail::system_memory>::local().release();
+}
+#  else
+/// returns the statistics of the pooled allocator of the calling thread.
+POLY_API pool_statistics pool_stats() noexcept;
+
+/// returns the memory cached by the pooled allocator of the calling thread to
+/// the system.
+POLY_API void release_pool() noexcept;
+#  endif
+#endif
+
+/// Default allocator of the sbo and heap storages. Satisfies the standard
+/// Allocator requirements and allocates with the same functions as the rest of
+/// poly. Unlike std::allocator, allocate() returns nullptr instead of throwing
+/// if the allocation fails.
+///
+/// The storages only use their allocator to obtain memory. Objects are
+/// constructed in that memory directly, not through the allocator.
+template<typename T>
+class allocator {
+public:
+  using value_type = T;
+
+  constexpr allocator() noexcept = default;
+
+  template<typename U>
+  constexpr allocator(const allocator<U>&) noexcept {}
+
+  [[nodiscard]] T* allocate(std::size_t n) noexcept {
+    return static_cast<T*>(detail::mem_alloc(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept { detail::mem_free(p); }
+};
+
+template<typename T, typename U>
+constexpr bool operator==(const allocator<T>&, const allocator<U>&) noexcept {
+  return true;
+}
+
+template<typename T, typename U>
+constexpr bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+  return false;
+}
+} // namespace poly
 #endif
@@ -0,0 +1,295 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_CLOSED_STRUCT_HPP
+#define POLY_CLOSED_STRUCT_HPP
+#include "poly/method_table.hpp"
+#include "poly/property_table.hpp"
+#include "poly/storage/variant_storage.hpp"
+#include "poly/vtable_policy.hpp"
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace poly {
+namespace detail {
+  template<POLY_TYPE_LIST Types, POLY_TYPE_LIST PropertySpecs,
+           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST OverLoads>
+  struct POLY_EMPTY_BASE closed_struct_impl;
+
+  template<template<typename...> typename L, typename... Ts,
+           POLY_PROP_SPEC... PropertySpecs, POLY_TYPE_LIST MethodSpecs,
+           typename... OverLoads>
+  struct POLY_EMPTY_BASE
+      closed_struct_impl<L<Ts...>, L<PropertySpecs...>, MethodSpecs,
+                         L<OverLoads...>>
+      : public detail::method_injector_for_t<
+            closed_struct_impl<L<Ts...>, L<PropertySpecs...>, MethodSpecs,
+                               L<OverLoads...>>,
+            OverLoads>...,
+        detail::property_injector_for_t<
+            closed_struct_impl<L<Ts...>, L<PropertySpecs...>, MethodSpecs,
+                               L<OverLoads...>>,
+            PropertySpecs>... {
+  public:
+    using types = L<Ts...>;
+    using method_specs = MethodSpecs;
+    using property_specs = L<PropertySpecs...>;
+    using storage_type = variant_storage<Ts...>;
+
+    /// only used for overload resolution of calls, no table is ever created.
+    using vtable_type = apply_t<method_specs, method_table>;
+
+    template<typename MethodName, typename... Args>
+    static constexpr bool nothrow_callable =
+        noexcept((*std::declval<const vtable_type*>())(
+            MethodName{}, std::declval<void*>(), std::declval<Args>()...));
+
+    template<typename Name>
+    using spec_for = list_spec_by_name_t<Name, property_specs>;
+    template<typename Name>
+    using value_type_for = value_type_t<spec_for<Name>>;
+    template<typename Name>
+    static constexpr bool is_nothrow = is_nothrow_property_v<spec_for<Name>>;
+    template<typename Name>
+    static constexpr bool is_const = is_const_property_v<spec_for<Name>>;
+
+    template<typename T>
+    static constexpr bool is_alternative = contains_v<types, std::decay_t<T>>;
+
+    static_assert(sizeof...(Ts) != 0,
+                  "A ClosedStruct needs at least one type.");
+    static_assert(poly::is_type_list_v<MethodSpecs>,
+                  "The MethodSpecs must be provided as a poly::type_list of "
+                  "MethodSpec.");
+    static_assert(
+        poly::conjunction_v<
+            poly::transform_t<method_specs, traits::is_method_spec>>,
+        "The provided MethodSpecs must be valid MethodSpecs, i.e. a function "
+        "type with signature Ret(MethodName, Args...)[const noexcept].");
+    static_assert(
+        poly::conjunction_v<
+            poly::transform_t<property_specs, traits::is_property_spec>>,
+        "The provided PropertySpecs must be valid PropertySpecs, i.e. a "
+        "function type with signature [const] Name(Type)[noexcept].");
+
+    constexpr closed_struct_impl() noexcept = default;
+
+    /// construct from a T
+    template<typename T, typename = std::enable_if_t<is_alternative<T>>>
+    constexpr closed_struct_impl(T&& t) noexcept(
+        std::is_nothrow_constructible_v<std::decay_t<T>, T&&>) {
+      storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
+    }
+
+    /// in place constructing a T
+    template<typename T, typename... Args>
+    constexpr closed_struct_impl(traits::Id<T>, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>) {
+      static_assert(is_alternative<T>,
+                    "T must be one of the types of the ClosedStruct.");
+      storage_.template emplace<T>(std::forward<Args>(args)...);
+    }
+
+    template<typename T, typename = std::enable_if_t<is_alternative<T>>>
+    constexpr closed_struct_impl& operator=(T&& t) noexcept(
+        std::is_nothrow_constructible_v<std::decay_t<T>, T&&>) {
+      storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
+      return *this;
+    }
+
+    /**
+     * call a non const method with arguments args.
+     * @param args parameters for the method
+     * @tparam MethodName name of the method
+     * @tparam Args argument types
+     * @returns the value returned by the method
+     */
+    template<typename MethodName, typename... Args>
+    constexpr decltype(auto)
+    call(Args&&... args) noexcept(nothrow_callable<MethodName, Args...>) {
+      static_assert(
+          std::is_invocable_v<const vtable_type, MethodName, void*, Args...>,
+          "Attempting to call a method that does not exist!");
+      assert(is_bound());
+      void* obj = storage_.data();
+      return visit([&](auto id) -> decltype(auto) {
+        return vtable_type::invoke_as(id, MethodName{}, obj,
+                                      std::forward<Args>(args)...);
+      });
+    }
+
+    /**
+     * Call a const method with arguments args.
+     * @param args parameters for the method
+     * @tparam MethodName name of the method
+     * @tparam Args argument types
+     * @returns the value returned by the method
+     */
+    template<typename MethodName, typename... Args>
+    constexpr decltype(auto) call(Args&&... args) const
+        noexcept(nothrow_callable<MethodName, Args...>) {
+      static_assert(std::is_invocable_v<const vtable_type,
+                                        MethodName,
+                                        const void*,
+                                        Args...>,
+                    "Attempting to call a method that does not exist!");
+      assert(is_bound());
+      const void* obj = storage_.data();
+      return visit([&](auto id) -> decltype(auto) {
+        return vtable_type::invoke_as(id, MethodName{}, obj,
+                                      std::forward<Args>(args)...);
+      });
+    }
+
+    /**
+     * Set the value of a property.
+     * @param value the new value of the property
+     * @tparam Name the properties name
+     * @returns boolean indicating if the new value was set (true) or not set
+     * (false).
+     */
+    template<typename Name, typename = std::enable_if_t<not is_const<Name>>>
+    constexpr bool
+    set(const value_type_for<Name>& value) noexcept(is_nothrow<Name>) {
+      assert(is_bound());
+      void* obj = storage_.data();
+      return visit([&](auto id) -> bool {
+        using T = typename decltype(id)::type;
+        using poly::set;
+        T& t = *static_cast<T*>(obj);
+        if constexpr (has_validator_v<T, spec_for<Name>>) {
+          using poly::check;
+          if (!check(Name{}, std::as_const(t), value))
+            return false;
+        }
+        set(Name{}, t, value);
+        return true;
+      });
+    }
+
+    /**
+     * Get the value of a property.
+     * @tparam Name the properties name
+     * @returns the properties value.
+     */
+    template<typename Name>
+    constexpr value_type_for<Name> get() const noexcept(is_nothrow<Name>) {
+      assert(is_bound());
+      const void* obj = storage_.data();
+      return visit([&](auto id) -> value_type_for<Name> {
+        using T = typename decltype(id)::type;
+        using poly::get;
+        return get(Name{}, *static_cast<const T*>(obj));
+      });
+    }
+
+    /**
+     * returns true if the bound object is of type T, else false.
+     */
+    template<typename T>
+    constexpr bool holds() const noexcept {
+      static_assert(is_alternative<T>,
+                    "T must be one of the types of the ClosedStruct.");
+      return storage_.index() == index_of_v<types, T>;
+    }
+
+    /**
+     * returns a pointer to the bound object if it is of type T, else nullptr.
+     */
+    /// @{
+    template<typename T>
+    constexpr T* target() noexcept {
+      return holds<T>() ? static_cast<T*>(storage_.data()) : nullptr;
+    }
+    template<typename T>
+    constexpr const T* target() const noexcept {
+      return holds<T>() ? static_cast<const T*>(storage_.data()) : nullptr;
+    }
+    /// @}
+
+    /**
+     * returns the index of the type of the bound object in Ts, or
+     * sizeof...(Ts) if no object is bound.
+     */
+    constexpr std::size_t index() const noexcept { return storage_.index(); }
+
+    /**
+     * returns true if an object is bound to the struct, i.e. the storage is not
+     * empty, else false.
+     */
+    constexpr bool is_bound() const noexcept {
+      return storage_.data() != nullptr;
+    }
+
+    /**
+     * same as is_bound().
+     */
+    constexpr operator bool() const noexcept { return is_bound(); }
+
+  private:
+    /// calls f with traits::Id<T> for the type T of the bound object. The
+    /// comparisons of the index are unrolled at compile time, so that the
+    /// compiler can turn them into a switch and inline the called function.
+    template<std::size_t I = 0, typename F>
+    constexpr decltype(auto) visit(F&& f) const {
+      using T = at_t<types, I>;
+      if constexpr (I + 1 == sizeof...(Ts)) {
+        return f(traits::Id<T>{});
+      } else {
+        if (storage_.index() == I)
+          return f(traits::Id<T>{});
+        return visit<I + 1>(std::forward<F>(f));
+      }
+    }
+
+    storage_type storage_{};
+  };
+} // namespace detail
+
+/// @addtogroup dispatch
+/// @{
+
+/// A Struct bound to objects of a closed set of types Ts.
+///
+/// ClosedStruct provides the same properties and methods as a Struct with the
+/// same PropertySpecs and MethodSpecs, including name injection. Objects are
+/// held in a poly::variant_storage<Ts...>, and instead of calling through a
+/// method table, calls compare the index of the bound type and call
+/// extend(), get() or set() of that type directly. This lets the compiler
+/// inline every alternative, like std::visit on a std::variant.
+///
+/// @code
+/// using Shape = poly::ClosedStruct<poly::type_list<Circle, Square>,
+///                                  POLY_PROPERTIES(),
+///                                  POLY_METHODS(int(area) const)>;
+/// Shape shape{Circle{2}};
+/// int a = shape.area();
+/// @endcode
+///
+/// @tparam Types a TypeList of the types which can be bound
+/// @tparam PropertySpecs a TypeList of @ref PropertySpec "PropertySpecs"
+/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs". Marks
+/// with poly::hot or poly::cold are accepted and ignored.
+template<POLY_TYPE_LIST Types, POLY_TYPE_LIST PropertySpecs,
+         POLY_TYPE_LIST MethodSpecs>
+using ClosedStruct = detail::closed_struct_impl<
+    Types, PropertySpecs, detail::arrange_methods_t<MethodSpecs>,
+    typename detail::collapse_overloads<
+        detail::arrange_methods_t<MethodSpecs>>::type>;
+/// @}
+} // namespace poly
+#endif
@@ -76,6 +76,53 @@ inline constexpr std::size_t max_property_count = 256;
 inline constexpr std::size_t max_property_count = POLY_MAX_PROPERTY_COUNT;
 #endif
 
+#ifndef POLY_MAX_INLINE_METHOD_COUNT
+inline constexpr std::size_t max_inline_method_count = 3;
+#else
+inline constexpr std::size_t max_inline_method_count =
+    POLY_MAX_INLINE_METHOD_COUNT;
+#endif
+
+/// maximum number of different source tables converted to the table of one
+/// flat Interface. Must be a power of two.
+#ifndef POLY_MAX_FLAT_TABLE_COUNT
+inline constexpr std::size_t max_flat_table_count = 64;
+#else
+inline constexpr std::size_t max_flat_table_count = POLY_MAX_FLAT_TABLE_COUNT;
+#endif
+
+#ifdef POLY_COMPACT_VTABLE
+#  define POLY_USE_COMPACT_VTABLE 1
+inline constexpr bool use_compact_vtable = true;
+#else
+#  define POLY_USE_COMPACT_VTABLE 0
+inline constexpr bool use_compact_vtable = false;
+#endif
+
+#ifdef POLY_POOLED_ALLOC
+#  define POLY_USE_POOLED_ALLOC 1
+inline constexpr bool use_pooled_alloc = true;
+#else
+#  define POLY_USE_POOLED_ALLOC 0
+inline constexpr bool use_pooled_alloc = false;
+#endif
+
+/// maximum number of bytes cached per size class and thread by the pooled
+/// allocator.
+#ifndef POLY_POOL_CACHE_SIZE
+inline constexpr std::size_t pool_cache_size = 64 * 1024;
+#else
+inline constexpr std::size_t pool_cache_size = POLY_POOL_CACHE_SIZE;
+#endif
+
+/// size of a cache line in bytes. Data written by different threads is kept
+/// this far apart to avoid false sharing.
+#ifndef POLY_CACHE_LINE_SIZE
+inline constexpr std::size_t cache_line_size = 64;
+#else
+inline constexpr std::size_t cache_line_size = POLY_CACHE_LINE_SIZE;
+#endif
+
 #if defined(_MSC_VER) && (_MSC_VER >= 1900)
 // needed for msvc to get EBCO right
 #  define POLY_EMPTY_BASE __declspec(empty_bases)
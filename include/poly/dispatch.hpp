@@ -0,0 +1,360 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_DISPATCH_HPP
+#define POLY_DISPATCH_HPP
+#include "poly/interface.hpp"
+#include "poly/struct.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace poly {
+namespace detail {
+  /// returned by poly::visit_as(). Calls methods of the Struct or Interface
+  /// through call_as<MethodName, Ts...>().
+  template<typename Object, typename... Ts>
+  class visitor {
+  public:
+    constexpr explicit visitor(Object& obj) noexcept : obj_(obj) {}
+
+    template<typename MethodName, typename... Args>
+    constexpr decltype(auto) call(Args&&... args) const
+        noexcept(noexcept(std::declval<Object&>()
+                              .template call_as<MethodName, Ts...>(
+                                  std::declval<Args>()...))) {
+      return obj_.template call_as<MethodName, Ts...>(
+          std::forward<Args>(args)...);
+    }
+
+  private:
+    Object& obj_;
+  };
+
+  /// provides access to the table pointer of Structs and Interfaces. Objects
+  /// with the same table pointer are bound to objects of the same type.
+  struct dispatch_access {
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static const void*
+    table(const struct_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.table();
+    }
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static const void*
+    table(const interface_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.vtbl_.table();
+    }
+
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static auto data(struct_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.storage_.data();
+    }
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static auto data(const struct_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.storage_.data();
+    }
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static auto data(interface_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.storage_.data();
+    }
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static auto data(const interface_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      return obj.storage_.data();
+    }
+
+    /// batch tables are only available for Structs and Interfaces using the
+    /// flat_vtable policy. Offset Interfaces do not know where the batch
+    /// table is stored in the table they adapt.
+    /// @{
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    static auto batch(const struct_impl<S, Ps, Ms, Os, P>& obj) noexcept {
+      assert(obj.table());
+      return obj.table()->batch;
+    }
+    template<typename S, typename Ps, typename Ms, typename Os>
+    static auto
+    batch(const interface_impl<S, Ps, Ms, Os, flat_vtable>& obj) noexcept {
+      assert(obj.vtbl_.table());
+      return obj.vtbl_.table()->batch;
+    }
+    /// @}
+
+    template<typename MethodName, typename Object, typename DataPtr,
+             typename... Args>
+    static auto call_batch(const Object& obj, DataPtr const* objs,
+                           std::size_t n, Args&... args)
+        -> decltype((*batch(obj))(MethodName{}, objs, n, args...)) {
+      return (*batch(obj))(MethodName{}, objs, n, args...);
+    }
+  };
+
+  template<typename Object, typename MethodName, typename DataPtr,
+           typename ArgList, typename = void>
+  struct is_batch_callable : std::false_type {};
+  template<typename Object, typename MethodName, typename DataPtr,
+           typename... Args>
+  struct is_batch_callable<
+      Object, MethodName, DataPtr, type_list<Args...>,
+      std::void_t<decltype(dispatch_access::call_batch<MethodName>(
+          std::declval<const Object&>(), std::declval<DataPtr const*>(),
+          std::size_t{}, std::declval<Args&>()...))>> : std::true_type {};
+
+  /// true if MethodName can be called with a single indirect call for a
+  /// group of Objects.
+  template<typename Object, typename MethodName, typename DataPtr,
+           typename... Args>
+  inline constexpr bool is_batch_callable_v =
+      is_batch_callable<Object, MethodName, DataPtr,
+                        type_list<Args...>>::value;
+} // namespace detail
+
+/// @addtogroup dispatch Dispatch
+/// Utilities to reduce the cost of indirect calls.
+/// @{
+
+/// Creates a visitor for obj, which calls methods directly if the object
+/// bound to obj is one of Ts. The check is a single comparison per type, which
+/// turns the indirect call into a predictable branch for the listed types.
+/// Objects of other types are called through the method table as usual.
+///
+/// @code
+/// poly::visit_as<Circle, Square>(shape).call<draw>(canvas);
+/// @endcode
+///
+/// @param obj a Struct or Interface
+/// @tparam Ts the likely types of the object bound to obj
+template<typename... Ts, typename Object>
+constexpr detail::visitor<Object, Ts...> visit_as(Object& obj) noexcept {
+  return detail::visitor<Object, Ts...>{obj};
+}
+
+/// Groups a range of Structs or Interfaces by the type of the bound objects.
+///
+/// Calling a method on a group calls the same function for every element of
+/// the group in a row, instead of jumping to a different function for
+/// neighbouring elements. Groups can be reused as long as the grouped objects
+/// are alive and not reassigned.
+///
+/// Groups are found by hashing the table pointer of each element, so grouping
+/// is linear in the number of elements. The relative order of elements within
+/// a group is preserved. Assigning a new range reuses the memory of the
+/// previous groups.
+///
+/// For Structs and Interfaces using the flat_vtable policy, each group is
+/// called with a single indirect call to trampoline::jump_batch, which calls
+/// extend() for every object of the group in a loop compiled for the bound
+/// type. Offset Interfaces, and methods whose arguments cannot be reused for
+/// several calls (e.g. rvalue references or move only types taken by value),
+/// are called per object.
+///
+/// The grouped objects are accessed through the const data() of their
+/// storage, so copy on write storages keep sharing their objects when const
+/// methods are called. Non const methods are batched only through a non
+/// const call_groups, which accesses the objects through the non const
+/// data() right before the call.
+///
+/// @tparam Object a (possibly const) Struct or Interface type
+template<typename Object>
+class call_groups {
+public:
+  call_groups() = default;
+
+  /// groups the elements of range
+  template<typename Range>
+  explicit call_groups(Range&& range) {
+    assign(std::forward<Range>(range));
+  }
+
+  /// replaces the current groups with groups of the elements of range
+  template<typename Range>
+  void assign(Range&& range) {
+    clear();
+    std::size_t last = 0;
+    for (Object& obj : range) {
+      const std::size_t g = find_group(detail::dispatch_access::table(obj),
+                                       last);
+      ++groups_[g].end;
+      last = g;
+    }
+    std::size_t offset = 0;
+    for (group& g : groups_) {
+      g.begin = offset;
+      offset += g.end;
+      g.end = g.begin;
+    }
+    objects_.resize(offset);
+    data_.resize(offset);
+    last = 0;
+    for (Object& obj : range) {
+      const std::size_t g = find_group(detail::dispatch_access::table(obj),
+                                       last);
+      data_[groups_[g].end] =
+          detail::dispatch_access::data(std::as_const(obj));
+      objects_[groups_[g].end++] = &obj;
+      last = g;
+    }
+  }
+
+  /// removes all groups. The memory is kept for the next assign().
+  void clear() noexcept {
+    groups_.clear();
+    objects_.clear();
+    data_.clear();
+    mutable_data_.clear();
+    std::fill(index_.begin(), index_.end(), std::size_t{0});
+  }
+
+  /// calls the method with name MethodName on every element. args are passed
+  /// as lvalues to each call.
+  /// @{
+  template<typename MethodName, typename... Args>
+  void call(Args&&... args) const {
+    for (const group& g : groups_) {
+      if constexpr (detail::is_batch_callable_v<Object, MethodName,
+                                                const void*, Args...>) {
+        detail::dispatch_access::call_batch<MethodName>(*objects_[g.begin],
+                                                        data_.data() + g.begin,
+                                                        g.end - g.begin,
+                                                        args...);
+      } else {
+        for (std::size_t i = g.begin; i != g.end; ++i)
+          objects_[i]->template call<MethodName>(args...);
+      }
+    }
+  }
+  template<typename MethodName, typename... Args>
+  void call(Args&&... args) {
+    if constexpr (not detail::is_batch_callable_v<Object, MethodName,
+                                                  const void*, Args...> and
+                  detail::is_batch_callable_v<Object, MethodName,
+                                              data_pointer, Args...>) {
+      mutable_data_.resize(objects_.size());
+      for (const group& g : groups_) {
+        for (std::size_t i = g.begin; i != g.end; ++i)
+          mutable_data_[i] = detail::dispatch_access::data(*objects_[i]);
+        detail::dispatch_access::call_batch<MethodName>(
+            *objects_[g.begin], mutable_data_.data() + g.begin,
+            g.end - g.begin, args...);
+      }
+    } else {
+      std::as_const(*this).template call<MethodName>(args...);
+    }
+  }
+  /// @}
+
+  /// number of grouped objects
+  std::size_t size() const noexcept { return objects_.size(); }
+
+  /// number of distinct types
+  std::size_t group_count() const noexcept { return groups_.size(); }
+
+private:
+  using data_pointer =
+      decltype(detail::dispatch_access::data(std::declval<Object&>()));
+
+  struct group {
+    const void* table;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  /// returns the index of the group of table, creating it if necessary.
+  /// Neighbouring elements mostly share a group, so the group of the previous
+  /// element is checked first.
+  std::size_t find_group(const void* table, std::size_t hint) {
+    if (hint < groups_.size() and groups_[hint].table == table)
+      return hint;
+    // keep the index at most half full, so probing always ends
+    if (2 * (groups_.size() + 1) > index_.size())
+      rehash(index_.empty() ? 16 : 2 * index_.size());
+    const std::size_t mask = index_.size() - 1;
+    for (std::size_t i = detail::pointer_hash(table);; ++i) {
+      std::size_t& slot = index_[i & mask];
+      if (slot == 0) {
+        groups_.push_back(group{table, 0, 0});
+        slot = groups_.size();
+        return slot - 1;
+      }
+      if (groups_[slot - 1].table == table)
+        return slot - 1;
+    }
+  }
+
+  /// resizes the index to size slots, a power of two, and reinserts the
+  /// groups.
+  void rehash(std::size_t size) {
+    index_.assign(size, 0);
+    const std::size_t mask = size - 1;
+    for (std::size_t g = 0; g != groups_.size(); ++g) {
+      std::size_t i = detail::pointer_hash(groups_[g].table);
+      while (index_[i & mask] != 0)
+        ++i;
+      index_[i & mask] = g + 1;
+    }
+  }
+
+  std::vector<group> groups_;
+  /// open addressing hash index of groups_ by table. Holds the index of the
+  /// group plus one, or zero for empty slots.
+  std::vector<std::size_t> index_;
+  std::vector<Object*> objects_;
+  /// const data pointers of objects_
+  std::vector<const void*> data_;
+  /// non const data pointers of objects_, taken before a non const method is
+  /// called.
+  std::vector<data_pointer> mutable_data_;
+};
+
+/// calls the method with name MethodName on every Struct or Interface in
+/// range, grouped by the type of the bound objects. See call_groups.
+///
+/// @code
+/// std::vector<Shape> shapes = ...;
+/// poly::for_each_call<draw>(shapes, canvas);
+/// @endcode
+///
+/// @param range a range of Structs or Interfaces
+/// @param args arguments passed as lvalues to each call
+/// @tparam MethodName the name of the method to call
+template<typename MethodName, typename Range, typename... Args>
+void for_each_call(Range&& range, Args&&... args) {
+  using object_type =
+      std::remove_reference_t<decltype(*std::begin(std::declval<Range&>()))>;
+  // the groups of each thread are reused, so that repeated calls do not
+  // allocate. A nested call from within a method uses its own groups.
+  thread_local call_groups<object_type> cached;
+  thread_local bool in_use = false;
+  if (in_use) {
+    call_groups<object_type> groups(range);
+    groups.template call<MethodName>(args...);
+    return;
+  }
+  // the groups point into range, so they are cleared before returning
+  struct release {
+    ~release() {
+      cached.clear();
+      in_use = false;
+    }
+  } guard;
+  in_use = true;
+  cached.assign(range);
+  cached.template call<MethodName>(args...);
+}
+/// @}
+} // namespace poly
+#endif
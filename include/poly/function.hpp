@@ -18,15 +18,37 @@
 #include "poly/storage.hpp"
 #include "poly/traits.hpp"
 #include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <utility>
 
 namespace poly {
 template<typename Sig, typename Derived>
 class function_impl;
 template<typename Sig, typename Storage>
 class function;
+template<typename Storage, typename... Sigs>
+class any_function;
+template<typename Sig, typename Storage>
+class once_function;
+template<typename Sig>
+class function_ref;
+template<typename Sig, std::size_t Size,
+         std::size_t Alignment = alignof(std::max_align_t)>
+class inplace_function;
 
 namespace detail {
 
+  /// empties the storage of a once_function when the invocation of its
+  /// callable ends, also if the callable throws.
+  template<typename Storage>
+  struct once_guard {
+    ~once_guard() { storage = Storage{}; }
+    Storage& storage;
+  };
+
   template<typename Sig>
   struct invoke_ptr;
   template<typename Ret, typename... Args>
@@ -41,9 +63,9 @@ namespace detail {
     template<typename Storage, typename F>
     static constexpr once_type<Storage> once =
         +[](Storage& storage, Args... args) -> Ret {
-      F f = std::move(*static_cast<F*>(storage.data()));
-      storage = Storage{};
-      return f(std::forward<Args>(args)...);
+      once_guard<Storage> guard{storage};
+      return (*static_cast<F*>(storage.data()))(
+          std::forward<Args>(args)...);
     };
   };
   template<typename Ret, typename... Args>
@@ -59,9 +81,9 @@ namespace detail {
     template<typename Storage, typename F>
     static constexpr once_type<Storage> once =
         +[](Storage& storage, Args... args) -> Ret {
-      const F f = std::move(*static_cast<F*>(storage.data()));
-      storage = Storage{};
-      return f(std::forward<Args>(args)...);
+      once_guard<Storage> guard{storage};
+      return (*static_cast<const F*>(storage.data()))(
+          std::forward<Args>(args)...);
     };
   };
   template<typename Ret, typename... Args>
@@ -76,9 +98,9 @@ namespace detail {
     template<typename Storage, typename F>
     static constexpr once_type<Storage> once =
         +[](Storage& storage, Args... args) noexcept -> Ret {
-      F f = std::move(*static_cast<F*>(storage.data()));
-      storage = Storage{};
-      return f(std::forward<Args>(args)...);
+      once_guard<Storage> guard{storage};
+      return (*static_cast<F*>(storage.data()))(
+          std::forward<Args>(args)...);
     };
   };
   template<typename Ret, typename... Args>
@@ -94,9 +116,9 @@ namespace detail {
     template<typename Storage, typename F>
     static constexpr once_type<Storage> once =
         +[](Storage& storage, Args... args) noexcept -> Ret {
-      const F f = std::move(*static_cast<F*>(storage.data()));
-      storage = Storage{};
-      return f(std::forward<Args>(args)...);
+      once_guard<Storage> guard{storage};
+      return (*static_cast<const F*>(storage.data()))(
+          std::forward<Args>(args)...);
     };
   };
   template<typename SigList, typename ArgList>
@@ -115,16 +137,61 @@ namespace detail {
         typename resolve_signature<type_list<Sigs...>,
                                    type_list<Args...>>::type>;
   };
+  /// entry of a function_table holding the invoke function of one
+  /// signature.
+  template<typename Sig>
+  struct function_entry {
+    typename invoke_ptr<Sig>::type invoke;
+  };
+
+  /// table of invoke functions of a callable for each of the signatures Sigs.
+  /// One table exists per callable type, so an any_function only stores a
+  /// pointer to it, independent of the number of signatures.
+  template<typename... Sigs>
+  struct function_table : function_entry<Sigs>... {
+    template<typename F>
+    constexpr function_table(traits::Id<F>) noexcept
+        : function_entry<Sigs>{invoke_ptr<Sigs>::template value<F>}... {}
+
+    /// returns the invoke function for the signature Sig
+    template<typename Sig>
+    constexpr typename invoke_ptr<Sig>::type get() const noexcept {
+      return static_cast<const function_entry<Sig>&>(*this).invoke;
+    }
+  };
+
+  template<typename F, typename... Sigs>
+  inline constexpr function_table<Sigs...> function_table_for{
+      traits::Id<F>{}};
+
   template<typename T>
   struct is_poly_function : std::false_type {};
   template<typename Sig, typename Derived>
   struct is_poly_function<function_impl<Sig, Derived>> : std::true_type {};
   template<typename Sig, typename Storage>
   struct is_poly_function<function<Sig, Storage>> : std::true_type {};
+  template<typename Storage, typename... Sigs>
+  struct is_poly_function<any_function<Storage, Sigs...>> : std::true_type {};
+  template<typename Sig, typename Storage>
+  struct is_poly_function<once_function<Sig, Storage>> : std::true_type {};
   template<typename Sig, typename Storage>
   class basic_function;
   template<typename Sig, typename Storage>
   struct is_poly_function<basic_function<Sig, Storage>> : std::true_type {};
+  template<typename Sig>
+  class basic_function_ref;
+  template<typename Sig>
+  struct is_poly_function<function_ref<Sig>> : std::true_type {};
+  template<typename Sig>
+  struct is_poly_function<basic_function_ref<Sig>> : std::true_type {};
+  template<typename Sig, std::size_t Size, std::size_t Alignment>
+  class basic_inplace_function;
+  template<typename Sig, std::size_t Size, std::size_t Alignment>
+  struct is_poly_function<inplace_function<Sig, Size, Alignment>>
+      : std::true_type {};
+  template<typename Sig, std::size_t Size, std::size_t Alignment>
+  struct is_poly_function<basic_inplace_function<Sig, Size, Alignment>>
+      : std::true_type {};
 
   template<typename Sig, typename Storage>
   class basic_function {
@@ -329,9 +396,12 @@ public:
     return Base::operator()(std::forward<Args>(args)...);
   }
 };
+/// Type erased callable with several signatures Sigs. The any_function holds
+/// the callable in Storage and a pointer to a table with one invoke function
+/// per signature. Calls select the signature whose decayed argument types
+/// match the decayed types of the arguments.
 template<typename Storage, typename... Sigs>
-class any_function
-    : public function_impl<Sigs, any_function<Storage, Sigs...>>... {
+class any_function {
 public:
   template<typename... Args>
   static constexpr bool is_nothrow_invocable =
@@ -351,8 +421,8 @@ public:
   template<typename F, typename = std::enable_if_t<not detail::is_poly_function<
                            std::decay_t<F>>::value>>
   constexpr any_function(F&& f) {
-    static_assert((traits::is_invocable_v<Sigs, std::decay_t<F>> or ...),
-                  "f is not callable with any of the signatures defined");
+    static_assert((traits::is_invocable_v<Sigs, std::decay_t<F>> and ...),
+                  "f is not callable with all of the signatures defined");
     this->bind(std::forward<F>(f));
   }
   constexpr any_function(const any_function& other) = default;
@@ -361,22 +431,20 @@ public:
   constexpr any_function& operator=(any_function&& other) = default;
   template<typename F>
   void bind(F&& f) {
-    ((static_cast<function_impl<Sigs, any_function<Storage, Sigs...>>*>(this)
-          ->invoke_ =
-          detail::invoke_ptr<Sigs>::template value<std::decay_t<F>>),
-     ...);
+    table_ = nullptr;
     storage_.template emplace<std::decay_t<F>>(std::forward<F>(f));
+    table_ = &detail::function_table_for<std::decay_t<F>, Sigs...>;
   }
 
   template<typename... Args,
            typename = std::enable_if_t<not is_const_invocable<Args...>>>
   constexpr return_type_for<Args...>
   operator()(Args&&... args) noexcept(is_nothrow_invocable<Args...>) {
-    using Sig =
-        typename detail::resolve_signature<type_list<Sigs...>,
-                                           type_list<decltype(args)...>>::type;
-    return (*static_cast<function_impl<Sig, any_function<Storage, Sigs...>>*>(
-        this))(std::forward<Args>(args)...);
+    using Sig = typename detail::resolve_signature<type_list<Sigs...>,
+                                                   type_list<Args...>>::type;
+    assert(table_);
+    return (*table_->template get<Sig>())(storage_.data(),
+                                          std::forward<Args>(args)...);
   }
 
   template<typename... Args,
@@ -385,18 +453,13 @@ public:
       noexcept(is_nothrow_invocable<Args...>) {
     using Sig = typename detail::resolve_signature<type_list<Sigs...>,
                                                    type_list<Args...>>::type;
-    return (*static_cast<function_impl<Sig, any_function<Storage, Sigs...>>*>(
-        this))(std::forward<Args>(args)...);
+    assert(table_);
+    return (*table_->template get<Sig>())(storage_.data(),
+                                          std::forward<Args>(args)...);
   }
 
 private:
-  template<typename S, typename D>
-  friend class function_impl;
-
-  void* data() noexcept { return storage_.data(); }
-
-  const void* data() const noexcept { return storage_.data(); }
-
+  const detail::function_table<Sigs...>* table_{nullptr};
   Storage storage_{};
 };
 
@@ -410,6 +473,8 @@ public:
 
   static constexpr bool is_nothrow = traits::func_is_noexcept<Sig>::value;
 
+  constexpr once_function() noexcept = default;
+
   template<typename F, typename = std::enable_if_t<not detail::is_poly_function<
                            std::decay_t<F>>::value>>
   constexpr once_function(F&& f) {
@@ -417,20 +482,54 @@ public:
   }
 
   constexpr once_function(const once_function& other) = default;
-  constexpr once_function(once_function&& other) = default;
+  constexpr once_function(once_function&& other) noexcept(
+      std::is_nothrow_move_constructible_v<Storage>)
+      : invoke_(std::exchange(other.invoke_, nullptr)),
+        storage_(std::move(other.storage_)) {}
   constexpr once_function& operator=(const once_function& other) = default;
-  constexpr once_function& operator=(once_function&& other) = default;
+  constexpr once_function& operator=(once_function&& other) noexcept(
+      std::is_nothrow_move_assignable_v<Storage>) {
+    if (this == &other)
+      return *this;
+    storage_ = std::move(other.storage_);
+    invoke_ = std::exchange(other.invoke_, nullptr);
+    return *this;
+  }
+
   template<typename F, typename = std::enable_if_t<not detail::is_poly_function<
                            std::decay_t<F>>::value>>
   void bind(F&& f) noexcept(
       std::is_nothrow_constructible_v<std::decay_t<F>, decltype(f)>) {
-    storage_.template emplace<std::decay_t<F>>(std::forward<F>(f));
-    this->invoke_ = detail::invoke_ptr<Sig>::template once<std::decay_t<F>>;
+    emplace<std::decay_t<F>>(std::forward<F>(f));
+  }
+
+  /// constructs a T from args directly in the storage and binds it.
+  template<typename T, typename... Args>
+  T* emplace(Args&&... args) noexcept(
+      std::is_nothrow_constructible_v<T, Args&&...>) {
+    invoke_ = nullptr;
+    T* ret = storage_.template emplace<T>(std::forward<Args>(args)...);
+    invoke_ = detail::invoke_ptr<Sig>::template once<Storage, T>;
+    return ret;
   }
 
+  /// Invokes the bound callable in place, without moving it out of the
+  /// storage, and destroys it afterwards, also if it throws. The
+  /// once_function is empty from the start of the invocation, so a reentrant
+  /// call from within the callable is an error. The callable must neither
+  /// assign to nor destroy the once_function it is invoked through. Calling
+  /// an empty or already invoked once_function terminates the program.
   template<typename... Args>
   constexpr return_type operator()(Args&&... args) noexcept(is_nothrow) {
-    return (*invoke_)(storage_, std::forward<Args>(args)...);
+    if (invoke_ == nullptr)
+      std::terminate();
+    return (*std::exchange(invoke_, nullptr))(storage_,
+                                              std::forward<Args>(args)...);
+  }
+
+  /// returns true if a callable is bound, which has not been invoked yet.
+  constexpr explicit operator bool() const noexcept {
+    return invoke_ != nullptr;
   }
 
 private:
@@ -441,12 +540,423 @@ private:
 
   const void* data() const noexcept { return storage_.data(); }
 
-  template<typename T, typename... Args>
-  T& emplace(Args&&... args) {
-    return storage_.template emplace<T>(std::forward<Args>(args)...);
-  }
-  invoke_ptr_t invoke_;
+  invoke_ptr_t invoke_{nullptr};
   Storage storage_{};
 };
+
+namespace detail {
+  /// referenced callable of a function_ref. Callable objects are referenced
+  /// by their address, functions by their function pointer.
+  union ref_object {
+    const void* obj;
+    void (*fn)();
+  };
+
+  /// invoke functions of a function_ref. direct_type is the function
+  /// pointer type, which is called without an invoke function.
+  template<typename Sig>
+  struct ref_invoke;
+  template<typename Ret, typename... Args>
+  struct ref_invoke<Ret(Args...)> {
+    using type = Ret (*)(ref_object, Args...);
+    using direct_type = Ret (*)(Args...);
+    template<typename F>
+    static constexpr type object = +[](ref_object o, Args... args) -> Ret {
+      return (*static_cast<F*>(const_cast<void*>(o.obj)))(
+          std::forward<Args>(args)...);
+    };
+    template<typename Fn>
+    static constexpr type function = +[](ref_object o, Args... args) -> Ret {
+      return (*reinterpret_cast<Fn>(o.fn))(std::forward<Args>(args)...);
+    };
+  };
+  template<typename Ret, typename... Args>
+  struct ref_invoke<Ret(Args...) const> {
+    using type = Ret (*)(ref_object, Args...);
+    using direct_type = Ret (*)(Args...);
+    template<typename F>
+    static constexpr type object = +[](ref_object o, Args... args) -> Ret {
+      return (*static_cast<const F*>(o.obj))(std::forward<Args>(args)...);
+    };
+    template<typename Fn>
+    static constexpr type function = +[](ref_object o, Args... args) -> Ret {
+      return (*reinterpret_cast<Fn>(o.fn))(std::forward<Args>(args)...);
+    };
+  };
+  template<typename Ret, typename... Args>
+  struct ref_invoke<Ret(Args...) noexcept> {
+    using type = Ret (*)(ref_object, Args...) noexcept;
+    using direct_type = Ret (*)(Args...) noexcept;
+    template<typename F>
+    static constexpr type object =
+        +[](ref_object o, Args... args) noexcept -> Ret {
+      return (*static_cast<F*>(const_cast<void*>(o.obj)))(
+          std::forward<Args>(args)...);
+    };
+    template<typename Fn>
+    static constexpr type function =
+        +[](ref_object o, Args... args) noexcept -> Ret {
+      return (*reinterpret_cast<Fn>(o.fn))(std::forward<Args>(args)...);
+    };
+  };
+  template<typename Ret, typename... Args>
+  struct ref_invoke<Ret(Args...) const noexcept> {
+    using type = Ret (*)(ref_object, Args...) noexcept;
+    using direct_type = Ret (*)(Args...) noexcept;
+    template<typename F>
+    static constexpr type object =
+        +[](ref_object o, Args... args) noexcept -> Ret {
+      return (*static_cast<const F*>(o.obj))(std::forward<Args>(args)...);
+    };
+    template<typename Fn>
+    static constexpr type function =
+        +[](ref_object o, Args... args) noexcept -> Ret {
+      return (*reinterpret_cast<Fn>(o.fn))(std::forward<Args>(args)...);
+    };
+  };
+
+  /// true if F is a function or a pointer to a function.
+  template<typename F>
+  inline constexpr bool is_function_like_v =
+      std::is_function_v<std::remove_pointer_t<std::decay_t<F>>>;
+
+  template<typename Sig>
+  class basic_function_ref {
+  public:
+    using return_type = typename traits::func_return_type<Sig>::type;
+    using argument_types = typename traits::func_args<Sig>::type;
+    using invoke_ptr_t = typename ref_invoke<Sig>::type;
+    using direct_ptr_t = typename ref_invoke<Sig>::direct_type;
+
+    static constexpr bool is_const = traits::func_is_const<Sig>::value;
+    static constexpr bool is_nothrow = traits::func_is_noexcept<Sig>::value;
+
+    /// references f. f must outlive the function_ref. Functions and function
+    /// pointers are stored by value, so a function pointer may be a
+    /// temporary. Function pointers convertible to direct_ptr_t are called
+    /// directly, other ones through an invoke function converting the
+    /// arguments. Owning poly functions are referenced like any other
+    /// callable object, function_refs of the same signature are copied.
+    template<typename F,
+             typename = std::enable_if_t<
+                 not std::is_base_of_v<basic_function_ref, std::decay_t<F>> and
+                 traits::is_invocable_v<Sig, std::remove_reference_t<F>>>>
+    constexpr basic_function_ref(F&& f) noexcept {
+      if constexpr (is_function_like_v<F> and
+                    std::is_convertible_v<std::decay_t<F>, direct_ptr_t>) {
+        assert(f != nullptr);
+        obj_.fn = reinterpret_cast<void (*)()>(static_cast<direct_ptr_t>(f));
+        invoke_ = nullptr;
+      } else if constexpr (is_function_like_v<F>) {
+        using Fn = std::decay_t<F>;
+        assert(f != nullptr);
+        obj_.fn = reinterpret_cast<void (*)()>(static_cast<Fn>(f));
+        invoke_ = ref_invoke<Sig>::template function<Fn>;
+      } else {
+        obj_.obj = std::addressof(f);
+        invoke_ =
+            ref_invoke<Sig>::template object<std::remove_reference_t<F>>;
+      }
+    }
+
+    constexpr basic_function_ref(const basic_function_ref&) noexcept = default;
+    constexpr basic_function_ref&
+    operator=(const basic_function_ref&) noexcept = default;
+
+  protected:
+    /// calls the callable through invoke_, or a direct function pointer
+    /// itself. Callable objects are the common case, so they are checked
+    /// first.
+    template<typename... Ts>
+    return_type call(Ts&&... args) const noexcept(is_nothrow) {
+      if (invoke_ != nullptr) [[likely]]
+        return (*invoke_)(obj_, std::forward<Ts>(args)...);
+      return (*reinterpret_cast<direct_ptr_t>(obj_.fn))(
+          std::forward<Ts>(args)...);
+    }
+
+    ref_object obj_;
+    /// nullptr if obj_.fn is a direct_ptr_t
+    invoke_ptr_t invoke_;
+  };
+} // namespace detail
+
+/// Non owning reference to a callable with the signature Sig. A function_ref
+/// consists of a pointer to the callable and a pointer to its invoke
+/// function, and is trivially copyable, so it is passed in registers.
+/// Function pointers matching Sig are called directly, without an invoke
+/// function in between. It is
+/// always bound and must not outlive the callable it references. Sig can be
+/// const and/or noexcept qualified, like for poly::function.
+template<typename Ret, typename... Args>
+class function_ref<Ret(Args...)>
+    : public detail::basic_function_ref<Ret(Args...)> {
+public:
+  using Base = detail::basic_function_ref<Ret(Args...)>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const {
+    return this->call(std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args>
+class function_ref<Ret(Args...) noexcept>
+    : public detail::basic_function_ref<Ret(Args...) noexcept> {
+public:
+  using Base = detail::basic_function_ref<Ret(Args...) noexcept>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const noexcept {
+    return this->call(std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args>
+class function_ref<Ret(Args...) const>
+    : public detail::basic_function_ref<Ret(Args...) const> {
+public:
+  using Base = detail::basic_function_ref<Ret(Args...) const>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const {
+    return this->call(std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args>
+class function_ref<Ret(Args...) const noexcept>
+    : public detail::basic_function_ref<Ret(Args...) const noexcept> {
+public:
+  using Base = detail::basic_function_ref<Ret(Args...) const noexcept>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const noexcept {
+    return this->call(std::forward<Args>(args)...);
+  }
+};
+
+namespace detail {
+  template<typename Sig, std::size_t Size, std::size_t Alignment>
+  class basic_inplace_function {
+  public:
+    template<typename S, std::size_t Sz, std::size_t A>
+    friend class basic_inplace_function;
+
+    using return_type = typename traits::func_return_type<Sig>::type;
+    using argument_types = typename traits::func_args<Sig>::type;
+    using invoke_ptr_t = typename invoke_ptr<Sig>::type;
+
+    static constexpr bool is_const = traits::func_is_const<Sig>::value;
+    static constexpr bool is_nothrow = traits::func_is_noexcept<Sig>::value;
+
+    /// true if F is copied with memcpy and never destroyed. Such callables
+    /// are stored without a resource_table.
+    template<typename F>
+    static constexpr bool is_trivial = std::is_trivially_copyable_v<F> and
+                                       std::is_trivially_destructible_v<F>;
+
+    constexpr basic_inplace_function() noexcept = default;
+
+    template<typename F,
+             typename = std::enable_if_t<
+                 not is_poly_function<std::decay_t<F>>::value>>
+    basic_inplace_function(F&& f) noexcept(
+        std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+      bind(std::forward<F>(f));
+    }
+
+    basic_inplace_function(const basic_inplace_function& other) {
+      copy(other);
+    }
+
+    template<std::size_t S, std::size_t A>
+    basic_inplace_function(const basic_inplace_function<Sig, S, A>& other) {
+      copy(other);
+    }
+
+    basic_inplace_function(basic_inplace_function&& other) noexcept {
+      move(other);
+    }
+
+    template<std::size_t S, std::size_t A>
+    basic_inplace_function(basic_inplace_function<Sig, S, A>&& other) noexcept {
+      move(other);
+    }
+
+    basic_inplace_function& operator=(const basic_inplace_function& other) {
+      if (this != &other) {
+        reset();
+        copy(other);
+      }
+      return *this;
+    }
+
+    basic_inplace_function& operator=(basic_inplace_function&& other) noexcept {
+      if (this != &other) {
+        reset();
+        move(other);
+      }
+      return *this;
+    }
+
+    ~basic_inplace_function() { reset(); }
+
+    /// constructs the callable in the buffer. The callable must fit into
+    /// Size bytes with an alignment of at most Alignment, be copy
+    /// constructible and nothrow move constructible.
+    template<typename F>
+    void bind(F&& f) noexcept(
+        std::is_nothrow_constructible_v<std::decay_t<F>, F&&>) {
+      using T = std::decay_t<F>;
+      static_assert(sizeof(T) <= Size,
+                    "The callable is too large for this inplace_function. "
+                    "Increase Size or capture less state.");
+      static_assert(alignof(T) <= Alignment,
+                    "The alignment of the callable is too large for this "
+                    "inplace_function. Increase Alignment.");
+      static_assert(std::is_copy_constructible_v<T>,
+                    "inplace_function requires a copy constructible callable.");
+      static_assert(std::is_nothrow_move_constructible_v<T>,
+                    "inplace_function requires a nothrow move constructible "
+                    "callable, because moving an inplace_function never "
+                    "throws.");
+      static_assert(traits::is_invocable_v<Sig, T>,
+                    "f is not callable with the signature defined");
+      reset();
+      poly::detail::construct_at(static_cast<T*>(data()), std::forward<F>(f));
+      if constexpr (not is_trivial<T>)
+        table_ = &resource_table_for<true, T>;
+      invoke_ = invoke_ptr<Sig>::template value<T>;
+    }
+
+    /// destroys the callable.
+    void reset() noexcept {
+      if (table_ and table_->destroy)
+        table_->destroy(buffer_);
+      table_ = nullptr;
+      invoke_ = nullptr;
+    }
+
+    /// returns true if a callable is bound.
+    constexpr explicit operator bool() const noexcept {
+      return invoke_ != nullptr;
+    }
+
+  protected:
+    void* data() noexcept { return buffer_; }
+
+    const void* data() const noexcept { return buffer_; }
+
+    invoke_ptr_t invoke_{nullptr};
+
+  private:
+    /// copies the callable of other into the empty buffer. Trivial callables
+    /// are copied by copying the whole buffer, whose size is known at compile
+    /// time.
+    template<std::size_t S, std::size_t A>
+    void copy(const basic_inplace_function<Sig, S, A>& other) {
+      static_assert(S <= Size, "The inplace_function to copy from is too big "
+                               "to fit into this");
+      static_assert(A <= Alignment, "The alignment of the inplace_function to "
+                                    "copy from is too big to fit into this");
+      if (other.invoke_ == nullptr)
+        return;
+      if (other.table_ and other.table_->copy)
+        other.table_->copy(buffer_, other.buffer_);
+      else
+        std::memcpy(buffer_, other.buffer_, S);
+      table_ = other.table_;
+      invoke_ = other.invoke_;
+    }
+
+    /// moves the callable of other into the empty buffer and empties other.
+    template<std::size_t S, std::size_t A>
+    void move(basic_inplace_function<Sig, S, A>& other) noexcept {
+      static_assert(S <= Size, "The inplace_function to move from is too big "
+                               "to fit into this");
+      static_assert(A <= Alignment, "The alignment of the inplace_function to "
+                                    "move from is too big to fit into this");
+      if (other.invoke_ == nullptr)
+        return;
+      if (other.table_ == nullptr or other.table_->relocatable) {
+        std::memcpy(buffer_, other.buffer_, S);
+      } else {
+        other.table_->move(buffer_, other.buffer_);
+        if (other.table_->destroy)
+          other.table_->destroy(other.buffer_);
+      }
+      table_ = std::exchange(other.table_, nullptr);
+      invoke_ = std::exchange(other.invoke_, nullptr);
+    }
+
+    const resource_table<true>* table_{nullptr};
+    alignas(Alignment) std::byte buffer_[Size];
+  };
+} // namespace detail
+
+/// Type erased callable with the signature Sig, which never allocates. The
+/// callable is stored in a buffer of Size bytes with an alignment of
+/// Alignment, and a callable that does not fit is a compile time error.
+/// Trivially copyable callables are copied and moved with memcpy, without
+/// calling through a table. Moves never throw. Sig can be const and/or
+/// noexcept qualified, like for poly::function.
+template<typename Ret, typename... Args, std::size_t Size, std::size_t Alignment>
+class inplace_function<Ret(Args...), Size, Alignment>
+    : public detail::basic_inplace_function<Ret(Args...), Size, Alignment> {
+public:
+  using Base = detail::basic_inplace_function<Ret(Args...), Size, Alignment>;
+  using Base::Base;
+
+  Ret operator()(Args... args) {
+    assert(this->invoke_);
+    return (*this->invoke_)(this->data(), std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args, std::size_t Size, std::size_t Alignment>
+class inplace_function<Ret(Args...) noexcept, Size, Alignment>
+    : public detail::basic_inplace_function<Ret(Args...) noexcept, Size,
+                                            Alignment> {
+public:
+  using Base =
+      detail::basic_inplace_function<Ret(Args...) noexcept, Size, Alignment>;
+  using Base::Base;
+
+  Ret operator()(Args... args) noexcept {
+    assert(this->invoke_);
+    return (*this->invoke_)(this->data(), std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args, std::size_t Size, std::size_t Alignment>
+class inplace_function<Ret(Args...) const, Size, Alignment>
+    : public detail::basic_inplace_function<Ret(Args...) const, Size,
+                                            Alignment> {
+public:
+  using Base =
+      detail::basic_inplace_function<Ret(Args...) const, Size, Alignment>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const {
+    assert(this->invoke_);
+    return (*this->invoke_)(this->data(), std::forward<Args>(args)...);
+  }
+};
+
+template<typename Ret, typename... Args, std::size_t Size, std::size_t Alignment>
+class inplace_function<Ret(Args...) const noexcept, Size, Alignment>
+    : public detail::basic_inplace_function<Ret(Args...) const noexcept, Size,
+                                            Alignment> {
+public:
+  using Base = detail::basic_inplace_function<Ret(Args...) const noexcept,
+                                              Size, Alignment>;
+  using Base::Base;
+
+  Ret operator()(Args... args) const noexcept {
+    assert(this->invoke_);
+    return (*this->invoke_)(this->data(), std::forward<Args>(args)...);
+  }
+};
 } // namespace poly
 #endif
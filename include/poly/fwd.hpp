@@ -19,8 +19,13 @@
 
 #include "poly/traits.hpp"
 
+#include <cstddef>
+
 namespace poly {
 
+template<typename T>
+class allocator;
+
 class ref_storage;
 
 template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
@@ -29,12 +34,22 @@ class local_storage;
 template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
 class move_only_local_storage;
 
-template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t),
+         typename Allocator = allocator<std::byte>>
 class sbo_storage;
 
-template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t),
+         typename Allocator = allocator<std::byte>>
 class move_only_sbo_storage;
 
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t),
+         typename Allocator = allocator<std::byte>>
+class cached_sbo_storage;
+
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t),
+         typename Allocator = allocator<std::byte>>
+class move_only_cached_sbo_storage;
+
 template<typename... Ts>
 class variant_storage;
 } // namespace poly
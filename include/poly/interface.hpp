@@ -16,29 +16,216 @@
 #ifndef POLY_INTERFACE_HPP
 #define POLY_INTERFACE_HPP
 
+#include "poly/alloc.hpp"
 #include "poly/interface_method_entry.hpp"
 #include "poly/interface_property_entry.hpp"
 #include "poly/struct.hpp"
 #include "poly/traits.hpp"
+#include "poly/vtable_policy.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
 
 namespace poly {
 namespace detail {
 
-  /// wrapper for an struct_table.
+  /// slot of the cache of dense Tables built from Source tables. The tables
+  /// live in the slot itself, so the cache never allocates.
+  template<typename Table, typename Source>
+  struct flat_table_slot {
+    struct tables {
+      explicit tables(const Source& source)
+          : batch(*source.batch), table(source, &batch) {}
+      typename Table::btable_type batch;
+      Table table;
+    };
+
+    /// source table the slot was built from, published after the tables
+    std::atomic<const Source*> key{nullptr};
+    /// set by the thread building the tables of this slot
+    std::atomic<bool> claimed{false};
+    alignas(tables) std::byte storage[sizeof(tables)]{};
+
+    const Table* table() const noexcept {
+      return &std::launder(reinterpret_cast<const tables*>(storage))->table;
+    }
+  };
+
+  /// statically allocated open addressing hash table of dense Tables, keyed
+  /// by the address of the Source table they were built from.
+  template<typename Table, typename Source>
+  inline flat_table_slot<Table, Source>
+      flat_table_slots[config::max_flat_table_count]{};
+
+  /// dense tables built after all slots in flat_table_slots<Table, Source>
+  /// are taken. Nodes are prepended under the mutex and never freed, so
+  /// lookups can walk the list without locking.
   /// @{
+  template<typename Table, typename Source>
+  struct flat_table_node {
+    flat_table_node(const Source* source, flat_table_node* next)
+        : tables(*source), key(source), next(next) {}
+
+    typename flat_table_slot<Table, Source>::tables tables;
+    const Source* key;
+    flat_table_node* next;
+  };
+
+  template<typename Table, typename Source>
+  struct flat_table_overflow {
+    std::atomic<flat_table_node<Table, Source>*> head{nullptr};
+    std::mutex mutex;
+  };
+
+  template<typename Table, typename Source>
+  inline flat_table_overflow<Table, Source> flat_table_overflows{};
+  /// @}
+
+  /// returns the dense table for source from the overflow list of the pair
+  /// of Table and Source, building it if needed.
+  template<typename Table, typename Source>
+  const Table* overflow_flat_table_for(const Source* source) {
+    auto& overflow = flat_table_overflows<Table, Source>;
+    const auto find =
+        [source](flat_table_node<Table, Source>* node) -> const Table* {
+      for (; node != nullptr; node = node->next) {
+        if (node->key == source)
+          return &node->tables.table;
+      }
+      return nullptr;
+    };
+    if (const Table* table =
+            find(overflow.head.load(std::memory_order_acquire)))
+      return table;
+    std::lock_guard<std::mutex> lock(overflow.mutex);
+    auto* head = overflow.head.load(std::memory_order_relaxed);
+    if (const Table* table = find(head))
+      return table;
+    auto* node = new flat_table_node<Table, Source>(source, head);
+    overflow.head.store(node, std::memory_order_release);
+    return &node->tables.table;
+  }
+
+  /// hashes a pointer, for open addressing hash tables keyed by addresses.
+  inline std::size_t pointer_hash(const void* p) noexcept {
+    const auto bits = reinterpret_cast<std::uintptr_t>(p) >> 3;
+    return static_cast<std::size_t>(bits * 0x9E3779B97F4A7C15ull >> 32);
+  }
+
+  /// returns a dense Table containing the entries of source needed by Table.
+  ///
+  /// The dense table is built on the first request for a source table, in a
+  /// static slot unique to the pair of Table and Source. Later requests find
+  /// it with one load in the slot its address hashes to. Once all
+  /// config::max_flat_table_count slots are taken, further tables are kept in
+  /// a slower overflow list.
+  template<typename Table, typename Source>
+  const Table* flat_table_for(const Source* source) noexcept {
+    assert(source);
+    if constexpr (std::is_same_v<Table, Source>) {
+      return source;
+    } else {
+      constexpr std::size_t mask = config::max_flat_table_count - 1;
+      static_assert((config::max_flat_table_count & mask) == 0,
+                    "POLY_MAX_FLAT_TABLE_COUNT must be a power of two.");
+      std::size_t index = pointer_hash(source);
+      for (std::size_t probe = 0; probe <= mask; ++probe, ++index) {
+        auto& slot = flat_table_slots<Table, Source>[index & mask];
+        const Source* key = slot.key.load(std::memory_order_acquire);
+        if (key == nullptr) {
+          if (not slot.claimed.exchange(true, std::memory_order_acq_rel)) {
+            using tables = typename flat_table_slot<Table, Source>::tables;
+            const tables* built = poly::detail::construct_at(
+                reinterpret_cast<tables*>(slot.storage), *source);
+            slot.key.store(source, std::memory_order_release);
+            return &built->table;
+          }
+          // another thread is building this slot, possibly for another source
+          while ((key = slot.key.load(std::memory_order_acquire)) == nullptr)
+            std::this_thread::yield();
+        }
+        if (key == source)
+          return slot.table();
+      }
+      return overflow_flat_table_for<Table>(source);
+    }
+  }
+
   template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
-  struct interface_table;
+  struct flat_interface_table;
+
+  /// Offsets of the entries of an Interface into the struct_table it is
+  /// bound to.
+  /// @{
+  template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  struct interface_offsets;
 
   template<template<typename...> typename L, POLY_PROP_SPEC... PropertySpecs,
            POLY_METHOD_SPEC... MethodSpecs>
-  struct interface_table<L<PropertySpecs...>, L<MethodSpecs...>>
+  struct interface_offsets<L<PropertySpecs...>, L<MethodSpecs...>>
       : public interface_method_entry<MethodSpecs>...,
         public interface_property_entry<PropertySpecs>... {
-  public:
     using interface_method_entry<MethodSpecs>::operator()...;
     using interface_property_entry<PropertySpecs>::set...;
     using interface_property_entry<PropertySpecs>::get...;
 
+    /// computes the offsets into a struct_table<Ps, Ms>
+    template<typename Ps, typename Ms>
+    explicit interface_offsets(traits::Id<struct_table<Ps, Ms>>) noexcept
+        // note: aggregate initialization of base classes on purpose->
+        // direclty initialize offset
+        : interface_method_entry<MethodSpecs>{struct_table<
+              Ps, Ms>::method_offset(traits::Id<MethodSpecs>{})}...,
+          interface_property_entry<PropertySpecs>{
+              struct_table<Ps, Ms>::property_offset(
+                  traits::Id<PropertySpecs>{})}... {
+      static_assert(
+          poly::detail::list_size<Ms>::value <= poly::config::max_method_count,
+          "Error while creating an Interface from a Struct: the number of "
+          "methods in the Struct exceeds POLY_MAX_METHOD_COUNT . Adjust the "
+          "POLY_MAX_METHOD_COUNT macro to reflect the maximum number of "
+          "methods accurately before including ANY poly header.");
+      static_assert(
+          poly::detail::list_size<Ps>::value <=
+              poly::config::max_property_count,
+          "Error while creating an Interface from a Struct: the number of "
+          "properties in the Struct exceeds POLY_MAX_PROPERTY_COUNT. Adjust "
+          "the macro to reflect the maximum number of porperties accurately "
+          "before including ANY poly header.");
+    }
+
+    /// copies the offsets of an offset block featuring a super set of
+    /// properties and methods
+    template<typename Ps, typename Ms>
+    explicit interface_offsets(const interface_offsets<Ps, Ms>& other) noexcept
+        : interface_method_entry<MethodSpecs>(
+              static_cast<const interface_method_entry<MethodSpecs>&>(
+                  other))...,
+          interface_property_entry<PropertySpecs>(
+              static_cast<const interface_property_entry<PropertySpecs>&>(
+                  other))... {}
+  };
+
+  /// @}
+
+  /// wrapper for an struct_table.
+  /// @{
+  template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  struct interface_table;
+
+  template<template<typename...> typename L, POLY_PROP_SPEC... PropertySpecs,
+           POLY_METHOD_SPEC... MethodSpecs>
+  struct interface_table<L<PropertySpecs...>, L<MethodSpecs...>>
+      : interface_offsets<L<PropertySpecs...>, L<MethodSpecs...>> {
+  public:
+    using offsets_type =
+        interface_offsets<L<PropertySpecs...>, L<MethodSpecs...>>;
+
     template<typename MethodName, typename... Args>
     static constexpr bool nothrow_callable =
         noexcept((*std::declval<const method_table<MethodSpecs...>*>())(
@@ -63,38 +250,19 @@ namespace detail {
     // properties and methods
     template<typename Ps, typename Ms>
     interface_table(const interface_table<Ps, Ms>& other)
-        : interface_method_entry<MethodSpecs>(
-              static_cast<const interface_method_entry<MethodSpecs>&>(
-                  other))...,
-          interface_property_entry<PropertySpecs>(
-              static_cast<const interface_property_entry<PropertySpecs>&>(
-                  other))...,
+        : offsets_type(static_cast<const typename interface_table<
+                           Ps, Ms>::offsets_type&>(other)),
           table_(other.table_) {}
 
+    // construct from a flat table featuring a super set of properties and
+    // methods
     template<typename Ps, typename Ms>
-    interface_table(const struct_table<Ps, Ms>* table)
-        // note: aggregate initialization of base classes on purpose->
-        // direclty initialize offset
-        : interface_method_entry<MethodSpecs>{struct_table<
-              Ps, Ms>::method_offset(traits::Id<MethodSpecs>{})}...,
-          interface_property_entry<PropertySpecs>{
-              struct_table<Ps, Ms>::property_offset(
-                  traits::Id<PropertySpecs>{})}...,
-          table_(table) {
-      static_assert(
-          poly::detail::list_size<Ms>::value <= poly::config::max_method_count,
-          "Error while creating an Interface from a Struct: the number of "
-          "methods in the Struct exceeds POLY_MAX_METHOD_COUNT . Adjust the "
-          "POLY_MAX_METHOD_COUNT macro to reflect the maximum number of "
-          "methods accurately before including ANY poly header.");
-      static_assert(
-          poly::detail::list_size<Ps>::value <=
-              poly::config::max_property_count,
-          "Error while creating an Interface from a Struct: the number of "
-          "properties in the Struct exceeds POLY_MAX_PROPERTY_COUNT. Adjust "
-          "the macro to reflect the maximum number of porperties accurately "
-          "before including ANY poly header.");
-    }
+    interface_table(const flat_interface_table<Ps, Ms>& other)
+        : interface_table(other.table()) {}
+
+    template<typename Ps, typename Ms>
+    interface_table(const struct_table<Ps, Ms>* table) noexcept
+        : offsets_type(traits::Id<struct_table<Ps, Ms>>{}), table_(table) {}
 
     template<typename MethodName, typename... Args>
     decltype(auto)
@@ -118,42 +286,172 @@ namespace detail {
              const value_type_for<Name>& value) noexcept(is_nothrow<Name>) {
       assert(obj);
       assert(table_);
-      return this->set(Name{}, table_, obj, value);
+      return offsets_type::set(Name{}, table_, obj, value);
     }
 
     template<typename Name>
     value_type_for<Name> get(const void* obj) noexcept(is_nothrow<Name>) {
       assert(obj);
       assert(table_);
-      return this->get(Name{}, table_, obj);
+      return offsets_type::get(Name{}, table_, obj);
+    }
+
+    template<typename T>
+    bool holds() const noexcept {
+      assert(table_);
+      return static_cast<const type_entry*>(table_)->template holds<T>();
     }
 
+    const void* table() const noexcept { return table_; }
+
   private:
+    template<POLY_TYPE_LIST Ps, POLY_TYPE_LIST Ms>
+    friend struct interface_table;
+
     const void* table_{
         nullptr}; ///< points to original struct_table this is created with
   };
   /// @}
 
+  /// table used by Interfaces with the flat_vtable policy. Only contains a
+  /// pointer to a struct_table with exactly the properties and methods of the
+  /// Interface.
+  /// @{
+  template<template<typename...> typename L, POLY_PROP_SPEC... PropertySpecs,
+           POLY_METHOD_SPEC... MethodSpecs>
+  struct flat_interface_table<L<PropertySpecs...>, L<MethodSpecs...>> {
+  public:
+    using table_type =
+        struct_table<L<PropertySpecs...>, L<MethodSpecs...>>;
+
+    template<typename MethodName, typename... Args>
+    static constexpr bool nothrow_callable =
+        noexcept((*std::declval<const method_table<MethodSpecs...>*>())(
+            MethodName{}, std::declval<void*>(), std::declval<Args>()...));
+
+    template<typename Name>
+    using spec_for = typename spec_by_name<Name, PropertySpecs...>::type;
+    template<typename Name>
+    using value_type_for = value_type_t<spec_for<Name>>;
+    template<typename Name>
+    static constexpr bool is_nothrow = is_nothrow_property_v<spec_for<Name>>;
+    template<typename Name>
+    static constexpr bool is_const = is_const_property_v<spec_for<Name>>;
+
+    constexpr flat_interface_table(const flat_interface_table&) noexcept =
+        default;
+    constexpr flat_interface_table(flat_interface_table&&) noexcept = default;
+    constexpr flat_interface_table&
+    operator=(const flat_interface_table&) noexcept = default;
+    constexpr flat_interface_table&
+    operator=(flat_interface_table&&) noexcept = default;
+
+    /// construct from a T directly. No conversion necessary.
+    template<typename T>
+    constexpr flat_interface_table(traits::Id<T>) noexcept
+        : table_(table_for<T, L<PropertySpecs...>, L<MethodSpecs...>>()) {}
+
+    // construct from other flat table featuring a super set of properties and
+    // methods
+    template<typename Ps, typename Ms>
+    flat_interface_table(const flat_interface_table<Ps, Ms>& other)
+        : table_(flat_table_for<table_type>(other.table())) {}
+
+    template<typename Ps, typename Ms>
+    flat_interface_table(const interface_table<Ps, Ms>&) {
+      static_assert(always_false<Ps>,
+                    "An Interface with the flat_vtable policy cannot be "
+                    "created from an Interface with the offset_vtable "
+                    "policy. Create it from the Struct instead.");
+    }
+
+    template<typename Ps, typename Ms>
+    flat_interface_table(const struct_table<Ps, Ms>* table)
+        : table_(flat_table_for<table_type>(table)) {}
+
+    template<typename MethodName, typename... Args>
+    decltype(auto)
+    call(void* obj,
+         Args&&... args) noexcept(nothrow_callable<MethodName, Args&&...>) {
+      assert(obj);
+      assert(table_);
+      return (*table_)(MethodName{}, obj, std::forward<Args>(args)...);
+    }
+
+    template<typename MethodName, typename... Args>
+    decltype(auto) call(const void* obj, Args&&... args) const
+        noexcept(nothrow_callable<MethodName, Args&&...>) {
+      assert(obj);
+      assert(table_);
+      return (*table_)(MethodName{}, obj, std::forward<Args>(args)...);
+    }
+
+    template<typename Name>
+    bool set(void* obj,
+             const value_type_for<Name>& value) noexcept(is_nothrow<Name>) {
+      assert(obj);
+      assert(table_);
+      return table_->set(Name{}, obj, value);
+    }
+
+    template<typename Name>
+    value_type_for<Name> get(const void* obj) noexcept(is_nothrow<Name>) {
+      assert(obj);
+      assert(table_);
+      return table_->get(Name{}, obj);
+    }
+
+    template<typename T>
+    constexpr bool holds() const noexcept {
+      assert(table_);
+      return table_->template holds<T>();
+    }
+
+    constexpr const table_type* table() const noexcept { return table_; }
+
+  private:
+    const table_type* table_{nullptr};
+  };
+  /// @}
+
   template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
-           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST OverLoads>
+           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST OverLoads,
+           typename VTablePolicy>
   struct interface_impl;
 
+  /// true if T is a Struct or an Interface
+  /// @{
+  template<typename T>
+  struct is_poly_object : std::false_type {};
+  template<typename S, typename Ps, typename Ms, typename Os, typename P>
+  struct is_poly_object<struct_impl<S, Ps, Ms, Os, P>> : std::true_type {};
+  template<typename S, typename Ps, typename Ms, typename Os, typename P>
+  struct is_poly_object<interface_impl<S, Ps, Ms, Os, P>> : std::true_type {};
+  template<typename T>
+  inline constexpr bool is_poly_object_v = is_poly_object<T>::value;
+  /// @}
+
   template<POLY_STORAGE StorageType, template<typename...> typename List,
            typename... PropertySpecs, typename... MethodSpecs,
-           typename... Overloads>
+           typename... Overloads, typename VTablePolicy>
   struct POLY_EMPTY_BASE
       interface_impl<StorageType, List<PropertySpecs...>, List<MethodSpecs...>,
-                     List<Overloads...>>
+                     List<Overloads...>, VTablePolicy>
       : detail::method_injector_for_t<
             interface_impl<StorageType, List<PropertySpecs...>,
-                           List<MethodSpecs...>, List<Overloads...>>,
+                           List<MethodSpecs...>, List<Overloads...>,
+                           VTablePolicy>,
             Overloads>...,
         detail::property_injector_for_t<
             interface_impl<StorageType, List<PropertySpecs...>,
-                           List<MethodSpecs...>, List<Overloads...>>,
+                           List<MethodSpecs...>, List<Overloads...>,
+                           VTablePolicy>,
             PropertySpecs>... {
-    using table_type =
-        detail::interface_table<List<PropertySpecs...>, List<MethodSpecs...>>;
+    using table_type = std::conditional_t<
+        is_flat_vtable_v<VTablePolicy>,
+        detail::flat_interface_table<List<PropertySpecs...>,
+                                     List<MethodSpecs...>>,
+        detail::interface_table<List<PropertySpecs...>, List<MethodSpecs...>>>;
 
   public:
     template<typename MethodName, typename... Args>
@@ -171,23 +469,34 @@ namespace detail {
     using property_specs = List<PropertySpecs...>;
     using method_specs = List<MethodSpecs...>;
 
-    template<typename S, typename Ps, typename Ms>
-    interface_impl(Struct<S, Ps, Ms>& obj)
-        : storage_(obj.storage_), vtbl_(obj.vtbl_) {}
+    template<typename S, typename Ps, typename Ms, typename Os, typename P>
+    interface_impl(struct_impl<S, Ps, Ms, Os, P>& obj)
+        : storage_(obj.storage_), vtbl_(obj.table()) {}
 
-    template<typename S, typename Ps, typename Ms,
+    template<typename S, typename Ps, typename Ms, typename Os, typename P,
              typename = std::enable_if_t<
                  std::is_constructible_v<StorageType, const S&>>>
-    interface_impl(const Struct<S, Ps, Ms>& obj) noexcept(
+    interface_impl(const struct_impl<S, Ps, Ms, Os, P>& obj) noexcept(
         std::is_nothrow_constructible_v<StorageType, const S&>)
-        : storage_(obj.storage_), vtbl_(obj.vtbl_) {}
+        : storage_(obj.storage_), vtbl_(obj.table()) {}
 
     template<
-        typename S, typename Ps, typename Ms,
+        typename S, typename Ps, typename Ms, typename Os, typename P,
         typename = std::enable_if_t<std::is_constructible_v<StorageType, S&&>>>
-    interface_impl(Struct<S, Ps, Ms>&& obj) noexcept(
+    interface_impl(struct_impl<S, Ps, Ms, Os, P>&& obj) noexcept(
         std::is_nothrow_constructible_v<StorageType, S&&>)
-        : storage_(std::move(obj.storage_)), vtbl_(obj.vtbl_) {}
+        : storage_(std::move(obj.storage_)), vtbl_(obj.table()) {}
+
+    /// construct from a T. Only available with the flat_vtable policy.
+    template<typename T, typename Policy = VTablePolicy,
+             typename = std::enable_if_t<is_flat_vtable_v<Policy> and
+                                         not is_poly_object_v<std::decay_t<T>>>>
+    interface_impl(T&& t) noexcept(
+        detail::nothrow_emplaceable_v<StorageType, std::decay_t<T>,
+                                      decltype(t)>)
+        : vtbl_(traits::Id<std::decay_t<T>>{}) {
+      storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
+    }
 
     interface_impl(const interface_impl& other) noexcept(
         std::is_nothrow_copy_constructible_v<StorageType>)
@@ -197,17 +506,17 @@ namespace detail {
         std::is_nothrow_move_constructible_v<StorageType>)
         : storage_(std::move(other.storage_)), vtbl_(other.vtbl_) {}
 
-    template<typename S, typename Ps, typename Ms, typename Os,
+    template<typename S, typename Ps, typename Ms, typename Os, typename P,
              typename = std::enable_if_t<
                  std::is_constructible_v<StorageType, const S&>>>
-    interface_impl(const interface_impl<S, Ps, Ms, Os>& other) noexcept(
+    interface_impl(const interface_impl<S, Ps, Ms, Os, P>& other) noexcept(
         std::is_nothrow_constructible_v<StorageType, const S&>)
         : storage_(other.storage_), vtbl_(other.vtbl_) {}
 
     template<
-        typename S, typename Ps, typename Ms, typename Os,
+        typename S, typename Ps, typename Ms, typename Os, typename P,
         typename = std::enable_if_t<std::is_constructible_v<StorageType, S&&>>>
-    interface_impl(interface_impl<S, Ps, Ms, Os>&& other) noexcept(
+    interface_impl(interface_impl<S, Ps, Ms, Os, P>&& other) noexcept(
         std::is_nothrow_constructible_v<StorageType, S&&>)
         : storage_(std::move(other.storage_)), vtbl_(other.vtbl_) {}
 
@@ -227,19 +536,20 @@ namespace detail {
       return *this;
     }
     template<
-        typename S, typename Ps, typename Ms, typename Os,
+        typename S, typename Ps, typename Ms, typename Os, typename P,
         typename = std::enable_if_t<std::is_assignable_v<StorageType, S&&>>>
-    interface_impl& operator=(interface_impl<S, Ps, Ms, Os>&& other) noexcept(
+    interface_impl&
+    operator=(interface_impl<S, Ps, Ms, Os, P>&& other) noexcept(
         std::is_nothrow_assignable_v<StorageType, S&&>) {
       storage_ = std::move(other.storage_);
       vtbl_ = other.vtbl_;
       return *this;
     }
-    template<typename S, typename Ps, typename Ms, typename Os,
+    template<typename S, typename Ps, typename Ms, typename Os, typename P,
              typename =
                  std::enable_if_t<std::is_assignable_v<StorageType, const S&>>>
     interface_impl&
-    operator=(const interface_impl<S, Ps, Ms, Os>& other) noexcept(
+    operator=(const interface_impl<S, Ps, Ms, Os, P>& other) noexcept(
         std::is_nothrow_assignable_v<StorageType, const S&>) {
       storage_ = other.storage_;
       vtbl_ = other.vtbl_;
@@ -249,8 +559,12 @@ namespace detail {
     template<typename MethodName, typename... Args>
     decltype(auto)
     call(Args&&... args) noexcept(nothrow_callable<MethodName, Args&&...>) {
-      return vtbl_.template call<MethodName>(storage_.data(),
-                                             std::forward<Args>(args)...);
+      if constexpr (is_mutating_call_v<vtable_type, MethodName, Args&&...>)
+        return vtbl_.template call<MethodName>(storage_.data(),
+                                               std::forward<Args>(args)...);
+      else
+        return std::as_const(*this).template call<MethodName>(
+            std::forward<Args>(args)...);
     }
 
     template<typename MethodName, typename... Args>
@@ -275,10 +589,89 @@ namespace detail {
       static_assert(
           contains_v<transform_t<property_specs, traits::property_name>, Name>,
           "Property not specified in this interface.");
-      return vtbl_.template get<Name>(storage_.data());
+      return vtbl_.template get<Name>(std::as_const(storage_).data());
+    }
+
+    /// call a method. If the bound object is one of Ts, the extension
+    /// function of that type is called directly instead of through the
+    /// method table. The types are checked in the order given.
+    /// @{
+    template<typename MethodName, typename... Ts, typename... Args>
+    decltype(auto)
+    call_as(Args&&... args) noexcept(nothrow_callable<MethodName, Args&&...>) {
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+
+    template<typename MethodName, typename... Ts, typename... Args>
+    decltype(auto) call_as(Args&&... args) const
+        noexcept(nothrow_callable<MethodName, Args&&...>) {
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+    /// @}
+
+    /// returns true if the bound object is of type T, else false.
+    template<typename T>
+    bool holds() const noexcept {
+      return vtbl_.template holds<T>();
+    }
+
+    /// returns a pointer to the bound object if it is of type T, else nullptr.
+    /// @{
+    template<typename T>
+    T* target() noexcept {
+      return holds<T>() ? static_cast<T*>(storage_.data()) : nullptr;
     }
+    template<typename T>
+    const T* target() const noexcept {
+      return holds<T>() ? static_cast<const T*>(storage_.data()) : nullptr;
+    }
+    /// @}
 
   private:
+    using vtable_type = method_table<MethodSpecs...>;
+
+    template<typename MethodName, typename T, typename... Ts, typename... Args>
+    decltype(auto) call_as_impl(type_list<T, Ts...>, Args&&... args) {
+      if constexpr (not is_mutating_call_v<vtable_type, MethodName,
+                                           Args&&...>) {
+        return std::as_const(*this).template call_as_impl<MethodName>(
+            type_list<T, Ts...>{}, std::forward<Args>(args)...);
+      } else {
+        if (holds<T>())
+          return vtable_type::invoke_as(traits::Id<T>{},
+                                        MethodName{},
+                                        storage_.data(),
+                                        std::forward<Args>(args)...);
+        return call_as_impl<MethodName>(type_list<Ts...>{},
+                                        std::forward<Args>(args)...);
+      }
+    }
+    template<typename MethodName, typename T, typename... Ts, typename... Args>
+    decltype(auto) call_as_impl(type_list<T, Ts...>, Args&&... args) const {
+      if (holds<T>())
+        return vtable_type::invoke_as(traits::Id<T>{},
+                                      MethodName{},
+                                      storage_.data(),
+                                      std::forward<Args>(args)...);
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+    template<typename MethodName, typename... Args>
+    decltype(auto) call_as_impl(type_list<>, Args&&... args) {
+      return call<MethodName>(std::forward<Args>(args)...);
+    }
+    template<typename MethodName, typename... Args>
+    decltype(auto) call_as_impl(type_list<>, Args&&... args) const {
+      return call<MethodName>(std::forward<Args>(args)...);
+    }
+
+    template<POLY_STORAGE, POLY_TYPE_LIST, POLY_TYPE_LIST, POLY_TYPE_LIST,
+             typename>
+    friend struct interface_impl;
+    friend struct poly::detail::dispatch_access;
+
     StorageType storage_;
     table_type vtbl_;
   };
@@ -294,7 +687,8 @@ namespace detail {
 ///
 /// Interfaces can only be created from Struct/Interfaces providing a super
 /// set of properties and methods, and not directly from types implementing
-/// the specified methods and properties.
+/// the specified methods and properties, unless the flat_vtable policy is
+/// used.
 ///
 /// @note Interfaces do not generate extra method and property tables, but
 /// adapt the tables from the Struct it is created from. This
@@ -312,21 +706,46 @@ namespace detail {
 /// @tparam StorageType storage used for objects emplaced. Must conform to the
 /// @ref Storage "poly::Storage" concept.
 /// @tparam PropertySpecs a TypeList of @ref PropertySpec "PropertySpecs"
-/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs"
+/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs", which may
+/// be marked poly::hot or poly::cold
+/// @tparam VTablePolicy either poly::offset_vtable(default) or
+/// poly::flat_vtable. See @ref vtable_policy "VTable Policies".
 /// @{
 /// @}
 template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
-         POLY_TYPE_LIST MethodSpecs>
+         POLY_TYPE_LIST MethodSpecs, typename VTablePolicy = offset_vtable>
 using Interface = detail::interface_impl<
-    StorageType, PropertySpecs, MethodSpecs,
-    typename detail::collapse_overloads<MethodSpecs>::type>;
+    StorageType, PropertySpecs, detail::arrange_methods_t<MethodSpecs>,
+    typename detail::collapse_overloads<
+        detail::arrange_methods_t<MethodSpecs>>::type,
+    VTablePolicy>;
 /// An non owning Interface. Can be used to pass Objects, References and other
 /// Interfaces.
 ///
 /// @warning The same lifetime restrictions apply as with @ref Reference
 /// "References".
+template<typename PropertySpecs, typename MethodSpecs,
+         typename VTablePolicy = offset_vtable>
+using InterfaceRef =
+    Interface<ref_storage, PropertySpecs, MethodSpecs, VTablePolicy>;
+
+/// An Interface using the flat_vtable policy. Calls only need a single
+/// indirection, and the Interface can be created directly from a T.
+///
+/// @note A FlatInterface can be created from Structs and other
+/// FlatInterfaces, but not from Interfaces using the offset_vtable policy.
+template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
+         POLY_TYPE_LIST MethodSpecs>
+using FlatInterface =
+    Interface<StorageType, PropertySpecs, MethodSpecs, flat_vtable>;
+
+/// An non owning FlatInterface.
+///
+/// @warning The same lifetime restrictions apply as with @ref Reference
+/// "References".
 template<typename PropertySpecs, typename MethodSpecs>
-using InterfaceRef = Interface<ref_storage, PropertySpecs, MethodSpecs>;
+using FlatInterfaceRef =
+    Interface<ref_storage, PropertySpecs, MethodSpecs, flat_vtable>;
 
 /// @}
 } // namespace poly
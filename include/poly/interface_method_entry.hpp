@@ -41,7 +41,7 @@ struct interface_method_entry<Ret(Method, Args...)> {
 };
 template<typename Ret, typename Method, typename... Args>
 struct interface_method_entry<Ret(Method, Args...) const> {
-  using signature_type = Ret(Method, Args...);
+  using signature_type = Ret(Method, Args...) const;
 
   Ret operator()(Method, const void* table, const void* obj,
                  Args... args) const {
@@ -56,7 +56,7 @@ struct interface_method_entry<Ret(Method, Args...) const> {
 };
 template<typename Ret, typename Method, typename... Args>
 struct interface_method_entry<Ret(Method, Args...) noexcept> {
-  using signature_type = Ret(Method, Args...);
+  using signature_type = Ret(Method, Args...) noexcept;
 
   Ret operator()(Method, const void* table, void* obj, Args... args) const {
     assert(table);
@@ -70,7 +70,7 @@ struct interface_method_entry<Ret(Method, Args...) noexcept> {
 };
 template<typename Ret, typename Method, typename... Args>
 struct interface_method_entry<Ret(Method, Args...) const noexcept> {
-  using signature_type = Ret(Method, Args...);
+  using signature_type = Ret(Method, Args...) const noexcept;
   Ret operator()(Method, const void* table, const void* obj,
                  Args... args) const {
     assert(table);
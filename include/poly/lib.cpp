@@ -6,23 +6,52 @@ namespace poly {
 
 namespace detail {
 
+  /// allocates from and frees to the system allocator
+  struct system_memory {
 #  ifdef POLY_ON_WINDOWS
+    static void* allocate(std::size_t size, std::size_t align) noexcept {
+      return _aligned_malloc(size, align);
+    }
+
+    static void deallocate(void* p) noexcept { _aligned_free(p); }
+#  else
+    static void* allocate(std::size_t size, std::size_t align) noexcept {
+      using namespace std;
+      return aligned_alloc(align, size);
+    }
+
+    static void deallocate(void* p) noexcept { std::free(p); }
+#  endif
+  };
+
+#  if POLY_USE_POOLED_ALLOC
   [[nodiscard]] POLY_API void* mem_alloc(std::size_t size,
                                          std::size_t align) noexcept {
-    return _aligned_malloc(size, align);
+    return pool<system_memory>::local().allocate(size, align);
   }
 
-  POLY_API void mem_free(void* p) noexcept { _aligned_free(p); }
+  POLY_API void mem_free(void* p) noexcept {
+    pool<system_memory>::local().deallocate(p);
+  }
 #  else
   [[nodiscard]] POLY_API void* mem_alloc(std::size_t size,
                                          std::size_t align) noexcept {
-    using namespace std;
-    return aligned_alloc(align, size);
+    return system_memory::allocate(size, align);
   }
 
-  POLY_API void mem_free(void* p) noexcept { std::free(p); }
+  POLY_API void mem_free(void* p) noexcept { system_memory::deallocate(p); }
 #  endif
 
 } // namespace detail
+
+#  if POLY_USE_POOLED_ALLOC
+POLY_API pool_statistics pool_stats() noexcept {
+  return detail::pool<detail::system_memory>::local().statistics();
+}
+
+POLY_API void release_pool() noexcept {
+  detail::pool<detail::system_memory>::local().release();
+}
+#  endif
 } // namespace poly
 #endif
@@ -16,9 +16,13 @@
 #ifndef POLY_METHOD_TABLE_HPP
 #define POLY_METHOD_TABLE_HPP
 #include "poly/method.hpp"
+#include "poly/table_function.hpp"
 #include "poly/traits.hpp"
 
 #include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 namespace poly::detail {
 template<typename Self, typename MethodSpecOrListOfSpecs>
 struct NullMethodInjector {};
@@ -161,6 +165,27 @@ struct trampoline<Ret(Method, Args...)> {
     using poly::extend;
     return extend(Method{}, *static_cast<T*>(t), std::forward<Args>(args)...);
   }
+
+  /// calls extend for n objects of type T. The arguments are passed as
+  /// lvalues to each call.
+  template<typename T>
+  static constexpr void jump_batch(Method, void* const* objs, std::size_t n,
+                                   Args... args) {
+    using poly::extend;
+    for (std::size_t i = 0; i != n; ++i)
+      extend(Method{}, *static_cast<T*>(objs[i]), args...);
+  }
+
+  /// calls extend for the n contiguous objects of type T starting at first.
+  /// The arguments are passed as lvalues to each call.
+  template<typename T>
+  static constexpr void jump_range(Method, void* first, std::size_t n,
+                                   Args... args) {
+    using poly::extend;
+    T* objs = static_cast<T*>(first);
+    for (std::size_t i = 0; i != n; ++i)
+      extend(Method{}, objs[i], args...);
+  }
 };
 template<typename Ret, typename Method, typename... Args>
 struct trampoline<Ret(Method, Args...) const> {
@@ -172,6 +197,27 @@ struct trampoline<Ret(Method, Args...) const> {
                   *static_cast<const T*>(t),
                   std::forward<Args>(args)...);
   }
+
+  /// calls extend for n objects of type T. The arguments are passed as
+  /// lvalues to each call.
+  template<typename T>
+  static constexpr void jump_batch(Method, const void* const* objs,
+                                   std::size_t n, Args... args) {
+    using poly::extend;
+    for (std::size_t i = 0; i != n; ++i)
+      extend(Method{}, *static_cast<const T*>(objs[i]), args...);
+  }
+
+  /// calls extend for the n contiguous objects of type T starting at first.
+  /// The arguments are passed as lvalues to each call.
+  template<typename T>
+  static constexpr void jump_range(Method, const void* first, std::size_t n,
+                                   Args... args) {
+    using poly::extend;
+    const T* objs = static_cast<const T*>(first);
+    for (std::size_t i = 0; i != n; ++i)
+      extend(Method{}, objs[i], args...);
+  }
 };
 template<typename Ret, typename Method, typename... Args>
 struct trampoline<Ret(Method, Args...) noexcept> {
@@ -225,13 +271,25 @@ struct method_entry<Ret(Method, Args...)> {
 
   constexpr method_entry() noexcept =default;
 
+  /// calls trampoline<MethodSpec>::jump<T> directly, bypassing func
+  template<typename T>
+  static constexpr Ret invoke_as(poly::traits::Id<T>, Method, void* t,
+                                 Args... args) {
+    assert(t);
+    return trampoline<Ret(Method, Args...)>::template jump<T>(
+        Method{}, t, std::forward<Args>(args)...);
+  }
+
+  /// selected by overload resolution if a call on a non const object
+  /// resolves to this entry. Only used in unevaluated contexts.
+  static std::true_type mutates(Method, void*, Args...) noexcept;
+
   constexpr Ret operator()(Method, void* t, Args... args) const {
     assert(func);
     assert(t);
-    return (*func)(Method{}, t, std::forward<Args>(args)...);
+    return (*func.get())(Method{}, t, std::forward<Args>(args)...);
   }
-  using func_pointer_t = Ret (*)(Method, void* t, Args...);
-  func_pointer_t func{nullptr};
+  table_function<Ret(Method, void*, Args...)> func;
 };
 
 /// VTable specialization for const method
@@ -244,13 +302,25 @@ struct method_entry<Ret(Method, Args...) const> {
 
   constexpr method_entry() noexcept =default;
 
+  /// calls trampoline<MethodSpec>::jump<T> directly, bypassing func
+  template<typename T>
+  static constexpr Ret invoke_as(poly::traits::Id<T>, Method, const void* t,
+                                 Args... args) {
+    assert(t);
+    return trampoline<Ret(Method, Args...) const>::template jump<T>(
+        Method{}, t, std::forward<Args>(args)...);
+  }
+
+  /// selected by overload resolution if a call on a non const object
+  /// resolves to this entry. Only used in unevaluated contexts.
+  static std::false_type mutates(Method, const void*, Args...) noexcept;
+
   constexpr Ret operator()(Method, const void* t, Args... args) const {
     assert(func);
     assert(t);
-    return (*func)(Method{}, t, std::forward<Args>(args)...);
+    return (*func.get())(Method{}, t, std::forward<Args>(args)...);
   }
-  using func_pointer_t = Ret (*)(Method, const void* t, Args...);
-  func_pointer_t func{nullptr};
+  table_function<Ret(Method, const void*, Args...)> func;
 };
 
 /// VTable specialization for non const noexcept method
@@ -263,13 +333,25 @@ struct method_entry<Ret(Method, Args...) noexcept> {
 
   constexpr method_entry() noexcept =default;
 
+  /// calls trampoline<MethodSpec>::jump<T> directly, bypassing func
+  template<typename T>
+  static constexpr Ret invoke_as(poly::traits::Id<T>, Method, void* t,
+                                 Args... args) noexcept {
+    assert(t);
+    return trampoline<Ret(Method, Args...)>::template jump<T>(
+        Method{}, t, std::forward<Args>(args)...);
+  }
+
+  /// selected by overload resolution if a call on a non const object
+  /// resolves to this entry. Only used in unevaluated contexts.
+  static std::true_type mutates(Method, void*, Args...) noexcept;
+
   constexpr Ret operator()(Method, void* t, Args... args) const noexcept {
     assert(func);
     assert(t);
-    return (*func)(Method{}, t, std::forward<Args>(args)...);
+    return (*func.get())(Method{}, t, std::forward<Args>(args)...);
   }
-  using func_pointer_t = Ret (*)(Method, void* t, Args...) noexcept;
-  func_pointer_t func{nullptr};
+  table_function<Ret(Method, void*, Args...) noexcept> func;
 };
 
 /// VTable specialization for const noexcept method
@@ -282,14 +364,26 @@ struct method_entry<Ret(Method, Args...) const noexcept> {
 
   constexpr method_entry() noexcept =default;
 
+  /// calls trampoline<MethodSpec>::jump<T> directly, bypassing func
+  template<typename T>
+  static constexpr Ret invoke_as(poly::traits::Id<T>, Method, const void* t,
+                                 Args... args) noexcept {
+    assert(t);
+    return trampoline<Ret(Method, Args...) const>::template jump<T>(
+        Method{}, t, std::forward<Args>(args)...);
+  }
+
+  /// selected by overload resolution if a call on a non const object
+  /// resolves to this entry. Only used in unevaluated contexts.
+  static std::false_type mutates(Method, const void*, Args...) noexcept;
+
   constexpr Ret operator()(Method, const void* t, Args... args) const noexcept {
     assert(func);
     assert(t);
-    return (*func)(Method{}, t, std::forward<Args>(args)...);
+    return (*func.get())(Method{}, t, std::forward<Args>(args)...);
   }
 
-  using func_pointer_t = Ret (*)(Method, const void* t, Args...) noexcept;
-  func_pointer_t func{nullptr};
+  table_function<Ret(Method, const void*, Args...) noexcept> func;
 };
 /// @}
 
@@ -303,12 +397,23 @@ struct method_table : private method_entry<MethodSpecs>... {
 
   static_assert((is_method_spec_v<MethodSpecs> && ...));
 
+  template<POLY_METHOD_SPEC... Specs>
+  friend struct method_table;
+
   using method_entry<MethodSpecs>::operator()...;
+  using method_entry<MethodSpecs>::invoke_as...;
+  using method_entry<MethodSpecs>::mutates...;
 
   template<typename T>
-  constexpr method_table(poly::traits::Id<T> id) noexcept
+  constexpr method_table([[maybe_unused]] poly::traits::Id<T> id) noexcept
       : method_entry<MethodSpecs>(id)... {}
 
+  /// copies the entries of a table featuring a super set of MethodSpecs
+  template<POLY_METHOD_SPEC... Specs>
+  constexpr method_table(const method_table<Specs...>& other) noexcept
+      : method_entry<MethodSpecs>(
+            static_cast<const method_entry<MethodSpecs>&>(other))... {}
+
   constexpr method_table() noexcept = default;
 
   /// used by InterfaceVTable
@@ -323,10 +428,178 @@ struct method_table : private method_entry<MethodSpecs>... {
   }
 };
 
+/// evaluates to true if calling MethodName with arguments of type Args on a
+/// non const object selects a non const method of the method_table VTable.
+/// Calls selecting a const method can access the object through the const
+/// data() of the storage, which lets copy on write storages keep sharing it.
+template<typename VTable, typename MethodName, typename... Args>
+inline constexpr bool is_mutating_call_v =
+    decltype(VTable::mutates(MethodName{},
+                             std::declval<void*>(),
+                             std::declval<Args>()...))::value;
+
 /// object vtable for T and a list of @ref MethodSpec "method specs"
 template<typename T, POLY_TYPE_LIST MethodSpecs>
 inline constexpr auto method_table_for =
     apply_t<MethodSpecs, method_table>(poly::traits::Id<T>{});
 
+/// true if arguments of types Args can be passed as lvalues to a function
+/// taking Args..., i.e. if the same arguments can be used for several calls.
+template<typename... Args>
+inline constexpr bool is_batchable_v =
+    (std::is_constructible_v<Args, std::remove_reference_t<Args>&> && ...);
+
+/// selects the trampoline used by a batch_entry
+/// @{
+/// objects are passed as an array of pointers, see trampoline::jump_batch
+struct batch_kind {
+  template<typename VoidPtr>
+  using objects_type = VoidPtr const*;
+
+  template<typename Spec, typename T>
+  static constexpr auto func() noexcept {
+    return &trampoline<Spec>::template jump_batch<T>;
+  }
+};
+/// objects are stored contiguously, see trampoline::jump_range
+struct range_kind {
+  template<typename VoidPtr>
+  using objects_type = VoidPtr;
+
+  template<typename Spec, typename T>
+  static constexpr auto func() noexcept {
+    return &trampoline<Spec>::template jump_range<T>;
+  }
+};
+/// @}
+
+/// Individual entry in the batch and range tables. Stores the address of
+/// trampoline<MethodSpec>::jump_batch or jump_range, if the arguments of the
+/// MethodSpec can be reused for several calls. Otherwise, the call operator is
+/// deleted.
+/// @{
+template<typename Kind, typename TrampolineSpec, typename VoidPtr,
+         typename Method, bool Batchable, typename... Args>
+struct batch_entry_base {
+  using objects_type = typename Kind::template objects_type<VoidPtr>;
+
+  template<typename T>
+  constexpr batch_entry_base(poly::traits::Id<T>) noexcept {}
+
+  constexpr batch_entry_base() noexcept = default;
+
+  void operator()(Method, objects_type objs, std::size_t n,
+                  Args... args) const = delete;
+};
+
+template<typename Kind, typename TrampolineSpec, typename VoidPtr,
+         typename Method, typename... Args>
+struct batch_entry_base<Kind, TrampolineSpec, VoidPtr, Method, true,
+                        Args...> {
+  using objects_type = typename Kind::template objects_type<VoidPtr>;
+
+  template<typename T>
+  constexpr batch_entry_base(poly::traits::Id<T>) noexcept
+      : func(Kind::template func<TrampolineSpec, T>()) {}
+
+  constexpr batch_entry_base() noexcept = default;
+
+  constexpr void operator()(Method, objects_type objs, std::size_t n,
+                            Args... args) const {
+    assert(func);
+    assert(objs or n == 0);
+    (*func)(Method{}, objs, n, args...);
+  }
+
+  using func_pointer_t = void (*)(Method, objects_type, std::size_t,
+                                  Args...);
+  func_pointer_t func{nullptr};
+};
+
+template<POLY_METHOD_SPEC MethodSpec, typename Kind = batch_kind>
+struct batch_entry;
+
+template<typename Ret, typename Method, typename... Args, typename Kind>
+struct batch_entry<Ret(Method, Args...), Kind>
+    : batch_entry_base<Kind, Ret(Method, Args...), void*, Method,
+                       is_batchable_v<Args...>, Args...> {
+  using batch_entry_base<Kind, Ret(Method, Args...), void*, Method,
+                         is_batchable_v<Args...>, Args...>::batch_entry_base;
+};
+
+template<typename Ret, typename Method, typename... Args, typename Kind>
+struct batch_entry<Ret(Method, Args...) const, Kind>
+    : batch_entry_base<Kind, Ret(Method, Args...) const, const void*, Method,
+                       is_batchable_v<Args...>, Args...> {
+  using batch_entry_base<Kind, Ret(Method, Args...) const, const void*,
+                         Method, is_batchable_v<Args...>,
+                         Args...>::batch_entry_base;
+};
+
+template<typename Ret, typename Method, typename... Args, typename Kind>
+struct batch_entry<Ret(Method, Args...) noexcept, Kind>
+    : batch_entry_base<Kind, Ret(Method, Args...), void*, Method,
+                       is_batchable_v<Args...>, Args...> {
+  using batch_entry_base<Kind, Ret(Method, Args...), void*, Method,
+                         is_batchable_v<Args...>, Args...>::batch_entry_base;
+};
+
+template<typename Ret, typename Method, typename... Args, typename Kind>
+struct batch_entry<Ret(Method, Args...) const noexcept, Kind>
+    : batch_entry_base<Kind, Ret(Method, Args...) const, const void*, Method,
+                       is_batchable_v<Args...>, Args...> {
+  using batch_entry_base<Kind, Ret(Method, Args...) const, const void*,
+                         Method, is_batchable_v<Args...>,
+                         Args...>::batch_entry_base;
+};
+/// @}
+
+/// Table of batch entries for a set of @ref MethodSpec "method specs". A batch
+/// call invokes a method for many objects of the same type with a single
+/// indirect call.
+template<POLY_METHOD_SPEC... MethodSpecs>
+struct batch_table : private batch_entry<MethodSpecs>... {
+  template<POLY_METHOD_SPEC... Specs>
+  friend struct batch_table;
+
+  using batch_entry<MethodSpecs>::operator()...;
+
+  template<typename T>
+  constexpr batch_table([[maybe_unused]] poly::traits::Id<T> id) noexcept
+      : batch_entry<MethodSpecs>(id)... {}
+
+  /// copies the entries of a table featuring a super set of MethodSpecs
+  template<POLY_METHOD_SPEC... Specs>
+  constexpr batch_table(const batch_table<Specs...>& other) noexcept
+      : batch_entry<MethodSpecs>(
+            static_cast<const batch_entry<MethodSpecs>&>(other))... {}
+
+  constexpr batch_table() noexcept = default;
+};
+
+/// Table of range entries for a set of @ref MethodSpec "method specs". A range
+/// call invokes a method for an array of objects of the same type with a
+/// single indirect call.
+template<POLY_METHOD_SPEC... MethodSpecs>
+struct range_table : private batch_entry<MethodSpecs, range_kind>... {
+  using batch_entry<MethodSpecs, range_kind>::operator()...;
+
+  template<typename T>
+  constexpr range_table([[maybe_unused]] poly::traits::Id<T> id) noexcept
+      : batch_entry<MethodSpecs, range_kind>(id)... {}
+
+  constexpr range_table() noexcept = default;
+};
+
+/// batch table for T and a list of @ref MethodSpec "method specs"
+template<typename T, POLY_TYPE_LIST MethodSpecs>
+inline constexpr auto batch_table_for =
+    apply_t<MethodSpecs, batch_table>(poly::traits::Id<T>{});
+
+/// range table for T and a list of @ref MethodSpec "method specs"
+template<typename T, POLY_TYPE_LIST MethodSpecs>
+inline constexpr auto range_table_for =
+    apply_t<MethodSpecs, range_table>(poly::traits::Id<T>{});
+
 } // namespace poly::detail
 #endif
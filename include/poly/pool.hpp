@@ -0,0 +1,227 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_POOL_HPP
+#define POLY_POOL_HPP
+#include "poly/config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace poly {
+
+/// statistics of the pooled allocator of the calling thread. Only available
+/// if poly is compiled with POLY_POOLED_ALLOC.
+struct pool_statistics {
+  /// number of allocations, including those too large for the pool
+  std::size_t allocations{0};
+  std::size_t pool_hits{0}; ///< allocations served from a free list
+  /// number of deallocations, including those of blocks not from the pool
+  std::size_t deallocations{0};
+  std::size_t cached_blocks{0}; ///< blocks currently held in free lists
+  std::size_t cached_bytes{0};  ///< bytes currently held in free lists
+};
+
+namespace detail {
+  inline constexpr std::size_t pool_size_classes = 20;
+  inline constexpr std::size_t pool_align_classes = 4; // 8, 16, 32, 64 bytes
+
+  constexpr std::size_t floor_log2(std::size_t n) noexcept {
+    std::size_t log = 0;
+    while (n >>= 1)
+      ++log;
+    return log;
+  }
+
+  /// returns the index of the size class for size bytes, preceded by offset
+  /// bytes. Size classes are multiples of 16 up to 128 bytes, followed by four
+  /// classes per power of two up to 1024 bytes. The offset is a power of two
+  /// between 8 and 64.
+  constexpr std::uint32_t pool_class_index(std::size_t size,
+                                           std::size_t offset) noexcept {
+    std::size_t index = 0;
+    if (size <= 128) {
+      index = size == 0 ? 0 : (size - 1) / 16;
+    } else {
+      const std::size_t log = floor_log2(size - 1);
+      index = 8 + (log - 7) * 4 +
+              ((size - 1 - (std::size_t{1} << log)) >> (log - 2));
+    }
+    return static_cast<std::uint32_t>(
+        (floor_log2(offset) - 3) * pool_size_classes + index);
+  }
+
+  /// returns the size in bytes of the size class index
+  constexpr std::size_t pool_class_size(std::uint32_t index) noexcept {
+    const std::size_t i = index % pool_size_classes;
+    if (i < 8)
+      return 16 * (i + 1);
+    const std::size_t log = 7 + (i - 8) / 4;
+    return (std::size_t{1} << log) +
+           ((i - 8) % 4 + 1) * (std::size_t{1} << (log - 2));
+  }
+
+  /// Size class pool used by mem_alloc() and mem_free() if poly is compiled
+  /// with POLY_POOLED_ALLOC.
+  ///
+  /// Requests of up to 1024 bytes with an alignment of at most 64 bytes are
+  /// rounded up to one of 20 size classes. Every thread keeps one free list
+  /// per size class and alignment. Freed blocks are pushed onto the free list
+  /// of the freeing thread, until the list holds config::pool_cache_size
+  /// bytes. Larger requests and blocks exceeding the cache go directly to
+  /// Upstream.
+  ///
+  /// Every block is preceded by a pool_header, so mem_free() does not need to
+  /// know the size or alignment of the block.
+  ///
+  /// @tparam Upstream type with static member functions
+  /// `void* allocate(std::size_t size, std::size_t align) noexcept` and
+  /// `void deallocate(void* p) noexcept`.
+  template<typename Upstream>
+  class pool {
+  public:
+    static constexpr std::size_t max_size = 1024;
+    static constexpr std::size_t max_align = 64;
+
+    /// returns the pool of the calling thread
+    static pool& local() noexcept {
+      thread_local pool instance;
+      thread_local exit_guard guard{instance};
+      return instance;
+    }
+
+    [[nodiscard]] void* allocate(std::size_t size,
+                                 std::size_t align) noexcept {
+      ++stats_.allocations;
+      const std::size_t offset =
+          align > sizeof(pool_header) ? align : sizeof(pool_header);
+      if (exited_ or size > max_size or offset > max_align)
+        return allocate_block(size, offset, unpooled);
+
+      const std::uint32_t index = pool_class_index(size, offset);
+      free_list& list = lists_[index];
+      if (list.head != nullptr) {
+        free_block* block = list.head;
+        list.head = block->next;
+        --list.count;
+        ++stats_.pool_hits;
+        --stats_.cached_blocks;
+        stats_.cached_bytes -= pool_class_size(index);
+        return block;
+      }
+      return allocate_block(pool_class_size(index), offset, index);
+    }
+
+    void deallocate(void* p) noexcept {
+      if (p == nullptr)
+        return;
+      ++stats_.deallocations;
+      pool_header header;
+      std::memcpy(&header, static_cast<std::byte*>(p) - sizeof(header),
+                  sizeof(header));
+      if (header.size_class == unpooled or exited_ or
+          (lists_[header.size_class].count + 1) *
+                  pool_class_size(header.size_class) >
+              config::pool_cache_size) {
+        Upstream::deallocate(static_cast<std::byte*>(p) - header.offset);
+        return;
+      }
+      free_list& list = lists_[header.size_class];
+      list.head = ::new (p) free_block{list.head};
+      ++list.count;
+      ++stats_.cached_blocks;
+      stats_.cached_bytes += pool_class_size(header.size_class);
+    }
+
+    /// returns all cached blocks of this pool to Upstream
+    void release() noexcept {
+      for (std::uint32_t index = 0; index != class_count; ++index) {
+        free_list& list = lists_[index];
+        while (list.head != nullptr) {
+          free_block* block = list.head;
+          list.head = block->next;
+          deallocate_cached(block);
+        }
+        list.count = 0;
+      }
+      stats_.cached_blocks = 0;
+      stats_.cached_bytes = 0;
+    }
+
+    pool_statistics statistics() const noexcept { return stats_; }
+
+  private:
+    static constexpr std::uint32_t class_count =
+        static_cast<std::uint32_t>(pool_size_classes * pool_align_classes);
+    static constexpr std::uint32_t unpooled = ~std::uint32_t{0};
+
+    struct pool_header {
+      std::uint32_t size_class;
+      std::uint32_t offset; ///< distance from the start of the allocation
+    };
+    struct free_block {
+      free_block* next;
+    };
+    struct free_list {
+      free_block* head{nullptr};
+      std::size_t count{0};
+    };
+
+    /// releases the pool of a thread when the thread exits. Blocks freed
+    /// after that are returned to Upstream directly.
+    struct exit_guard {
+      pool& p;
+      ~exit_guard() {
+        p.release();
+        p.exited_ = true;
+      }
+    };
+
+    /// allocates size bytes preceded by offset bytes, of which the last ones
+    /// hold the header.
+    static void* allocate_block(std::size_t size, std::size_t offset,
+                                std::uint32_t size_class) noexcept {
+      const std::size_t align = offset > alignof(std::max_align_t)
+                                    ? offset
+                                    : alignof(std::max_align_t);
+      // aligned_alloc requires the size to be a multiple of the alignment
+      const std::size_t total = (size + offset + align - 1) / align * align;
+      void* raw = Upstream::allocate(total, align);
+      if (raw == nullptr)
+        return nullptr;
+      std::byte* p = static_cast<std::byte*>(raw) + offset;
+      const pool_header header{size_class, static_cast<std::uint32_t>(offset)};
+      std::memcpy(p - sizeof(header), &header, sizeof(header));
+      return p;
+    }
+
+    static void deallocate_cached(free_block* block) noexcept {
+      pool_header header;
+      std::memcpy(&header,
+                  reinterpret_cast<std::byte*>(block) - sizeof(header),
+                  sizeof(header));
+      Upstream::deallocate(reinterpret_cast<std::byte*>(block) -
+                           header.offset);
+    }
+
+    free_list lists_[class_count]{};
+    pool_statistics stats_{};
+    bool exited_{false};
+  };
+} // namespace detail
+} // namespace poly
+#endif
@@ -17,8 +17,10 @@
 #define POLY_OBJECT_PROPERTY_HPP
 #include "poly/config.hpp"
 #include "poly/property.hpp"
+#include "poly/table_function.hpp"
 #include "poly/traits.hpp"
 
+#include <cstddef>
 #include <utility>
 
 namespace poly {
@@ -170,10 +172,10 @@ namespace detail {
     constexpr Type get(Name, const void* t) const {
       assert(get_);
       assert(t);
-      return (*get_)(Name{}, t);
+      return (*get_.get())(Name{}, t);
     }
 
-    Type (*get_)(Name, const void*) = nullptr;
+    table_function<Type(Name, const void*)> get_;
   };
 
   template<typename Name, typename Type>
@@ -201,10 +203,10 @@ namespace detail {
     constexpr Type get(Name, const void* t) const noexcept {
       assert(get_);
       assert(t);
-      return (*get_)(Name{}, t);
+      return (*get_.get())(Name{}, t);
     }
 
-    Type (*get_)(Name, const void*) = nullptr;
+    table_function<Type(Name, const void*) noexcept> get_;
   };
   template<typename Name, typename Type>
   struct property_entry<Name(Type)> {
@@ -229,16 +231,16 @@ namespace detail {
     constexpr bool set(Name, void* t, const Type& value) const {
       assert(set_);
       assert(t);
-      return (*set_)(Name{}, t, value);
+      return (*set_.get())(Name{}, t, value);
     }
     constexpr Type get(Name, const void* t) const {
       assert(get_);
       assert(t);
-      return (*get_)(Name{}, t);
+      return (*get_.get())(Name{}, t);
     }
 
-    bool (*set_)(Name, void*, const Type&) = nullptr;
-    Type (*get_)(Name, const void*) = nullptr;
+    table_function<bool(Name, void*, const Type&)> set_;
+    table_function<Type(Name, const void*)> get_;
   };
   template<typename Name, typename Type>
   struct property_entry<Name(Type) noexcept> {
@@ -247,9 +249,11 @@ namespace detail {
         : set_{+[](Name, void* t, const Type& value) -> bool {
             using poly::set;
             static_assert(
-                noexcept(set(std::declval<Name>(), std::declval<T&>())),
-                "Property specified noexcept, but set(Name, T&) is "
-                "not noexcept");
+                noexcept(set(std::declval<Name>(),
+                             std::declval<T&>(),
+                             std::declval<const Type&>())),
+                "Property specified noexcept, but set(Name, T&, const Type&) "
+                "is not noexcept");
             if constexpr (has_validator_v<T, Name(Type)>) {
               using poly::check;
               static_assert(
@@ -273,17 +277,17 @@ namespace detail {
     constexpr bool set(Name, void* t, const Type& value) const noexcept {
       assert(set_);
       assert(t);
-      return (*set_)(Name{}, t, value);
+      return (*set_.get())(Name{}, t, value);
     }
 
     constexpr Type get(Name, const void* t) const noexcept {
       assert(get_);
       assert(t);
-      return (*get_)(Name{}, t);
+      return (*get_.get())(Name{}, t);
     }
 
-    void (*set_)(Name, void*, const Type&) = nullptr;
-    Type (*get_)(Name, const void*) = nullptr;
+    table_function<bool(Name, void*, const Type&)> set_;
+    table_function<Type(Name, const void*)> get_;
   };
   /// @}
 
@@ -295,9 +299,15 @@ namespace detail {
     constexpr property_table() noexcept = default;
 
     template<typename T>
-    constexpr property_table(poly::traits::Id<T> id) noexcept
+    constexpr property_table([[maybe_unused]] poly::traits::Id<T> id) noexcept
         : property_entry<PropertySpec>(id)... {}
 
+    /// copies the entries of a table featuring a super set of PropertySpecs
+    template<POLY_PROP_SPEC... Specs>
+    constexpr property_table(const property_table<Specs...>& other) noexcept
+        : property_entry<PropertySpec>(
+              static_cast<const property_entry<PropertySpec>&>(other))... {}
+
     template<POLY_PROP_SPEC Spec>
     static property_offset_type property_offset(traits::Id<Spec>) noexcept {
       static_assert(
@@ -317,6 +327,59 @@ namespace detail {
       property_table<PropertySpecs...>(poly::traits::Id<T>{});
   /// @}
 
+  /// Entry in the property range table. Reads a property of n contiguous
+  /// objects of the same type with a single indirect call. The loop is
+  /// compiled for the type of the objects, so get() can be inlined.
+  /// @{
+  template<typename Name, typename Type>
+  struct property_range_entry_base {
+    template<typename T>
+    constexpr property_range_entry_base(poly::traits::Id<T>) noexcept
+        : get_all_(+[](Name, const void* first, std::size_t n, Type* out) {
+            using poly::get;
+            const T* objs = static_cast<const T*>(first);
+            for (std::size_t i = 0; i != n; ++i)
+              out[i] = get(Name{}, objs[i]);
+          }) {}
+    constexpr property_range_entry_base() noexcept = default;
+
+    constexpr void get_all(Name, const void* first, std::size_t n,
+                           Type* out) const {
+      assert(get_all_);
+      assert((first and out) or n == 0);
+      (*get_all_)(Name{}, first, n, out);
+    }
+
+    void (*get_all_)(Name, const void*, std::size_t, Type*) = nullptr;
+  };
+
+  template<POLY_PROP_SPEC PropertySpec>
+  struct property_range_entry
+      : property_range_entry_base<property_name_t<PropertySpec>,
+                                  value_type_t<PropertySpec>> {
+    using property_range_entry_base<
+        property_name_t<PropertySpec>,
+        value_type_t<PropertySpec>>::property_range_entry_base;
+  };
+  /// @}
+
+  /// table of property range entries
+  template<POLY_PROP_SPEC... PropertySpecs>
+  struct property_range_table : property_range_entry<PropertySpecs>... {
+    using property_range_entry<PropertySpecs>::get_all...;
+
+    template<typename T>
+    constexpr property_range_table(
+        [[maybe_unused]] poly::traits::Id<T> id) noexcept
+        : property_range_entry<PropertySpecs>(id)... {}
+
+    constexpr property_range_table() noexcept = default;
+  };
+
+  template<typename T, POLY_TYPE_LIST PropertySpecs>
+  inline constexpr auto property_range_table_for =
+      apply_t<PropertySpecs, property_range_table>(poly::traits::Id<T>{});
+
   /// returns the Spec in Specs belonging to Name
   template<typename Name, POLY_PROP_SPEC... Specs>
   struct spec_by_name {
@@ -328,6 +391,18 @@ namespace detail {
     using type = at_t<filter_t<type_list<Specs...>, predicate>, 0>;
   };
 
+  /// returns the Spec in the TypeList Specs belonging to Name
+  /// @{
+  template<typename Name, POLY_TYPE_LIST Specs>
+  struct list_spec_by_name;
+  template<typename Name, template<typename...> typename L,
+           POLY_PROP_SPEC... Specs>
+  struct list_spec_by_name<Name, L<Specs...>> : spec_by_name<Name, Specs...> {
+  };
+  template<typename Name, POLY_TYPE_LIST Specs>
+  using list_spec_by_name_t = typename list_spec_by_name<Name, Specs>::type;
+  /// @}
+
 } // namespace detail
 } // namespace poly
 #endif
@@ -0,0 +1,422 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_SEGMENTED_VECTOR_HPP
+#define POLY_SEGMENTED_VECTOR_HPP
+#include "poly/alloc.hpp"
+#include "poly/struct.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace poly {
+namespace detail {
+  /// type erased operations on a contiguous segment of T, and the tables of T.
+  template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  struct segment_table {
+    using reference = Reference<PropertySpecs, MethodSpecs>;
+
+    /// the table used by Structs bound to a T. Identifies the segment.
+    const struct_table<PropertySpecs, MethodSpecs>* table;
+    std::size_t size;
+    std::size_t align;
+    /// move constructs n objects from src into dst and destroys them in src.
+    void (*relocate)(void* dst, void* src, std::size_t n) noexcept;
+    /// destroys n objects starting at first.
+    void (*destroy)(void* first, std::size_t n) noexcept;
+    /// creates a Reference to the object at obj.
+    reference (*make_reference)(void* obj) noexcept;
+    /// range entries of T for the MethodSpecs.
+    apply_t<MethodSpecs, range_table> ranges;
+    /// property range entries of T for the PropertySpecs.
+    apply_t<PropertySpecs, property_range_table> properties;
+  };
+
+  /// the segment table for T
+  template<typename T, POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  inline constexpr segment_table<PropertySpecs, MethodSpecs>
+      segment_table_for{
+          table_for<T, PropertySpecs, MethodSpecs>(),
+          sizeof(T),
+          alignof(T),
+          +[](void* dst, void* src, std::size_t n) noexcept {
+            T* d = static_cast<T*>(dst);
+            T* s = static_cast<T*>(src);
+            for (std::size_t i = 0; i != n; ++i) {
+              poly::detail::construct_at(d + i, std::move(s[i]));
+              std::destroy_at(s + i);
+            }
+          },
+          +[](void* first, std::size_t n) noexcept {
+            T* objs = static_cast<T*>(first);
+            for (std::size_t i = 0; i != n; ++i)
+              std::destroy_at(objs + i);
+          },
+          +[](void* obj) noexcept {
+            return Reference<PropertySpecs, MethodSpecs>(*static_cast<T*>(obj));
+          },
+          range_table_for<T, MethodSpecs>,
+          property_range_table_for<T, PropertySpecs>};
+} // namespace detail
+
+/// @addtogroup dispatch
+/// @{
+
+/// A container for objects implementing the PropertySpecs and MethodSpecs,
+/// which stores objects of the same type contiguously in a segment.
+///
+/// Compared to a std::vector of Structs, there is no per element storage or
+/// table pointer, and calling a method on all objects only performs one
+/// indirect call per type. The loop over the objects of a segment is compiled
+/// for that type, so the extend() functions can be inlined.
+///
+/// Segments are ordered by the first insertion of an object of their type,
+/// objects inside a segment by insertion. Individual objects are accessed
+/// through @ref Reference "References".
+///
+/// Objects must be nothrow move constructible, as they are relocated when a
+/// segment grows. Inserting an object invalidates references to objects of
+/// the same type.
+///
+/// @tparam PropertySpecs a TypeList of @ref PropertySpec "PropertySpecs"
+/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs", which may
+/// be marked poly::hot or poly::cold
+template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+class segmented_vector {
+  using method_specs = detail::arrange_methods_t<MethodSpecs>;
+  using segment_table = detail::segment_table<PropertySpecs, method_specs>;
+  using range_table = apply_t<method_specs, detail::range_table>;
+  template<typename Name>
+  using value_type_for =
+      value_type_t<detail::list_spec_by_name_t<Name, PropertySpecs>>;
+
+  struct segment {
+    const segment_table* table;
+    void* data;
+    std::size_t size;
+    std::size_t capacity;
+  };
+
+public:
+  using reference = Reference<PropertySpecs, MethodSpecs>;
+  using size_type = std::size_t;
+
+  /// forward iterator over all objects. Dereferencing returns a Reference to
+  /// the object, which is const for a const_iterator.
+  template<bool Const>
+  class basic_iterator {
+  public:
+    using value_type = typename segmented_vector::reference;
+    using reference =
+        std::conditional_t<Const, const value_type, value_type>;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    basic_iterator() noexcept = default;
+
+    /// converts an iterator into a const_iterator
+    template<bool C, typename = std::enable_if_t<Const and not C>>
+    basic_iterator(const basic_iterator<C>& other) noexcept
+        : segments_(other.segments_), segment_(other.segment_),
+          index_(other.index_) {}
+
+    reference operator*() const noexcept {
+      const segment& seg = (*segments_)[segment_];
+      return seg.table->make_reference(static_cast<std::byte*>(seg.data) +
+                                       index_ * seg.table->size);
+    }
+
+    basic_iterator& operator++() noexcept {
+      if (++index_ == (*segments_)[segment_].size) {
+        index_ = 0;
+        skip_empty(segment_ + 1);
+      }
+      return *this;
+    }
+    basic_iterator operator++(int) noexcept {
+      basic_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(const basic_iterator& a,
+                           const basic_iterator& b) noexcept {
+      return a.segment_ == b.segment_ and a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator& a,
+                           const basic_iterator& b) noexcept {
+      return not(a == b);
+    }
+
+  private:
+    friend class segmented_vector;
+    template<bool C>
+    friend class basic_iterator;
+
+    basic_iterator(const std::vector<segment>* segments,
+                   std::size_t seg) noexcept
+        : segments_(segments) {
+      skip_empty(seg);
+    }
+
+    void skip_empty(std::size_t seg) noexcept {
+      while (seg != segments_->size() and (*segments_)[seg].size == 0)
+        ++seg;
+      segment_ = seg;
+    }
+
+    const std::vector<segment>* segments_{nullptr};
+    std::size_t segment_{0};
+    std::size_t index_{0};
+  };
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  segmented_vector() noexcept = default;
+  segmented_vector(const segmented_vector&) = delete;
+  segmented_vector(segmented_vector&& other) noexcept
+      : segments_(std::move(other.segments_)),
+        size_(std::exchange(other.size_, 0)) {
+    other.segments_.clear();
+  }
+  segmented_vector& operator=(const segmented_vector&) = delete;
+  segmented_vector& operator=(segmented_vector&& other) noexcept {
+    if (this != &other) {
+      release();
+      segments_ = std::move(other.segments_);
+      size_ = std::exchange(other.size_, 0);
+      other.segments_.clear();
+    }
+    return *this;
+  }
+  ~segmented_vector() { release(); }
+
+  /// constructs a T at the end of the segment for T.
+  /// @returns a reference to the new object
+  template<typename T, typename... Args>
+  T& emplace_back(Args&&... args) {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "Objects stored in a segmented_vector must be nothrow move "
+                  "constructible.");
+    segment& seg = segment_for<T>();
+    T* obj = nullptr;
+    if (seg.size == seg.capacity) {
+      // args may refer to objects in the segment, so the new object is
+      // constructed in the new buffer before the old ones are relocated.
+      const std::size_t capacity = seg.capacity == 0 ? 4 : 2 * seg.capacity;
+      void* mem = allocate(seg, capacity);
+      try {
+        obj = poly::detail::construct_at(static_cast<T*>(mem) + seg.size,
+                                         std::forward<Args>(args)...);
+      } catch (...) {
+        detail::mem_free(mem);
+        throw;
+      }
+      adopt(seg, mem, capacity);
+    } else {
+      obj = poly::detail::construct_at(static_cast<T*>(seg.data) + seg.size,
+                                       std::forward<Args>(args)...);
+    }
+    ++seg.size;
+    ++size_;
+    return *obj;
+  }
+
+  /// inserts t at the end of the segment for std::decay_t<T>.
+  /// @returns a reference to the new object
+  template<typename T>
+  std::decay_t<T>& push_back(T&& t) {
+    return emplace_back<std::decay_t<T>>(std::forward<T>(t));
+  }
+
+  /// reserves space for n objects of type T.
+  template<typename T>
+  void reserve(size_type n) {
+    segment& seg = segment_for<T>();
+    if (n > seg.capacity)
+      grow(seg, n);
+  }
+
+  /// destroys all objects. Segments and their memory are kept.
+  void clear() noexcept {
+    for (segment& seg : segments_) {
+      seg.table->destroy(seg.data, seg.size);
+      seg.size = 0;
+    }
+    size_ = 0;
+  }
+
+  /// @returns the total number of objects
+  size_type size() const noexcept { return size_; }
+
+  /// @returns true if no object is stored
+  bool empty() const noexcept { return size_ == 0; }
+
+  /// @returns the number of objects of type T
+  template<typename T>
+  size_type count() const noexcept {
+    const segment* seg = find<T>();
+    return seg ? seg->size : 0;
+  }
+
+  /// @returns the number of distinct types, which have been stored
+  size_type segment_count() const noexcept { return segments_.size(); }
+
+  /// @returns a pointer to the contiguous objects of type T, or nullptr if no
+  /// object of type T has been stored.
+  /// @{
+  template<typename T>
+  T* data() noexcept {
+    const segment* seg = find<T>();
+    return seg ? static_cast<T*>(seg->data) : nullptr;
+  }
+  template<typename T>
+  const T* data() const noexcept {
+    const segment* seg = find<T>();
+    return seg ? static_cast<const T*>(seg->data) : nullptr;
+  }
+  /// @}
+
+  /// @returns a Reference to the i-th object in iteration order.
+  reference operator[](size_type i) noexcept {
+    assert(i < size_);
+    for (const segment& seg : segments_) {
+      if (i < seg.size)
+        return seg.table->make_reference(static_cast<std::byte*>(seg.data) +
+                                         i * seg.table->size);
+      i -= seg.size;
+    }
+    return reference{};
+  }
+
+  iterator begin() noexcept { return iterator(&segments_, 0); }
+  iterator end() noexcept { return iterator(&segments_, segments_.size()); }
+  const_iterator begin() const noexcept {
+    return const_iterator(&segments_, 0);
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(&segments_, segments_.size());
+  }
+
+  /// calls the method with name MethodName on every object, segment by
+  /// segment. The arguments are passed as lvalues to each call.
+  /// @{
+  template<typename MethodName, typename... Args>
+  void call(Args&&... args) {
+    for (const segment& seg : segments_)
+      call_segment<MethodName>(seg, seg.data, args...);
+  }
+  template<typename MethodName, typename... Args>
+  void call(Args&&... args) const {
+    for (const segment& seg : segments_)
+      call_segment<MethodName>(seg,
+                               static_cast<const void*>(seg.data),
+                               args...);
+  }
+  /// @}
+
+  /// reads the property with name Name of all objects into out, in iteration
+  /// order. Reading the property performs one indirect call per segment.
+  /// @param out points to space for at least size() values
+  /// @returns out + size()
+  template<typename Name>
+  value_type_for<Name>* get_all(value_type_for<Name>* out) const {
+    for (const segment& seg : segments_) {
+      seg.table->properties.get_all(Name{}, seg.data, seg.size, out);
+      out += seg.size;
+    }
+    return out;
+  }
+
+private:
+
+  template<typename MethodName, typename VoidPtr, typename... Args>
+  static void call_segment(const segment& seg, VoidPtr data, Args&... args) {
+    static_assert(std::is_invocable_v<const range_table&, MethodName, VoidPtr,
+                                      std::size_t, Args&...>,
+                  "The method cannot be called on all objects with these "
+                  "arguments. Arguments are passed as lvalues to each call, "
+                  "which rules out rvalue references and move only types "
+                  "taken by value.");
+    seg.table->ranges(MethodName{}, data, seg.size, args...);
+  }
+
+  template<typename T>
+  const segment* find() const noexcept {
+    // compares type tags, so that the tables for T are only instantiated
+    // when a T is inserted
+    for (const segment& seg : segments_) {
+      if (seg.table->table->template holds<T>())
+        return &seg;
+    }
+    return nullptr;
+  }
+
+  template<typename T>
+  segment& segment_for() {
+    if (const segment* seg = find<T>())
+      return const_cast<segment&>(*seg);
+    segments_.push_back(segment{
+        &detail::segment_table_for<T, PropertySpecs, method_specs>,
+        nullptr,
+        0,
+        0});
+    return segments_.back();
+  }
+
+  static void grow(segment& seg, std::size_t capacity) {
+    adopt(seg, allocate(seg, capacity), capacity);
+  }
+
+  /// allocates a buffer for capacity objects of the type of seg
+  static void* allocate(const segment& seg, std::size_t capacity) {
+    void* mem = detail::mem_alloc(capacity * seg.table->size,
+                                  seg.table->align);
+    if (mem == nullptr)
+      throw std::bad_alloc{};
+    return mem;
+  }
+
+  /// relocates the objects of seg into mem and makes mem its buffer
+  static void adopt(segment& seg, void* mem, std::size_t capacity) noexcept {
+    if (seg.data) {
+      seg.table->relocate(mem, seg.data, seg.size);
+      detail::mem_free(seg.data);
+    }
+    seg.data = mem;
+    seg.capacity = capacity;
+  }
+
+  void release() noexcept {
+    for (segment& seg : segments_) {
+      seg.table->destroy(seg.data, seg.size);
+      if (seg.data)
+        detail::mem_free(seg.data);
+    }
+    segments_.clear();
+    size_ = 0;
+  }
+
+  std::vector<segment> segments_;
+  size_type size_{0};
+};
+/// @}
+} // namespace poly
+#endif
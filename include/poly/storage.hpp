@@ -19,18 +19,27 @@
  * - ref_storage: a non owning storage type.
  * - (move_only_)local_storage: storage without dynamic allocation
  * - (move_only_)sbo_storage: storage with small buffer optimization
+ * - (move_only_)arena_storage: storage with small buffer optimization, which
+ *   allocates from an arena.
  * - (move_only_)heap_storage: storage which always allocates on the heap.
  *   Always stores values on the heap.
+ * - (atomic_)shared_storage: storage sharing ownership of a heap allocated
+ *   object between copies.
+ * - (atomic_)cow_storage: shared_storage, which copies the object before it
+ *   is modified.
  * - variant_storage: stores any of the types provided as its template
  *   arguments.
  */
 #ifndef POLY_STRORAGE_HPP
 #define POLY_STRORAGE_HPP
 
+#include "poly/storage/arena_storage.hpp"
+#include "poly/storage/cow_storage.hpp"
 #include "poly/storage/heap_storage.hpp"
 #include "poly/storage/local_storage.hpp"
 #include "poly/storage/ref_storage.hpp"
 #include "poly/storage/sbo_storage.hpp"
+#include "poly/storage/shared_storage.hpp"
 #include "poly/storage/variant_storage.hpp"
 
 #endif
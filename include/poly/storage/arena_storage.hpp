@@ -0,0 +1,169 @@
+/**
+ * Copyright 2024 Pelé Constam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POLY_STORAGE_ARENA_STORAGE_HPP
+#define POLY_STORAGE_ARENA_STORAGE_HPP
+#include "poly/alloc.hpp"
+#include "poly/config.hpp"
+#include "poly/fwd.hpp"
+#include "poly/storage/sbo_storage.hpp"
+
+#include <cstdint>
+#include <utility>
+
+namespace poly {
+
+/// Bump allocator. Memory is handed out from a user supplied buffer, or from
+/// blocks allocated with mem_alloc() once the buffer is exhausted. Memory is
+/// never freed individually, release() frees all of it at once.
+class arena {
+public:
+  static constexpr std::size_t default_block_size = 64 * 1024;
+
+  /// construct an arena without initial buffer, which allocates blocks of
+  /// block_size bytes.
+  explicit arena(std::size_t block_size = default_block_size) noexcept
+      : block_size_(block_size) {}
+
+  /// construct an arena, which first allocates from buffer and then from
+  /// blocks of block_size bytes. The buffer must outlive the arena.
+  arena(void* buffer, std::size_t size,
+        std::size_t block_size = default_block_size) noexcept
+      : cur_(static_cast<std::byte*>(buffer)),
+        end_(static_cast<std::byte*>(buffer) + size),
+        buffer_(static_cast<std::byte*>(buffer)), buffer_size_(size),
+        block_size_(block_size) {}
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  ~arena() { release(); }
+
+  /// allocates size bytes with alignment align.
+  /// @returns pointer to the memory, or nullptr if no block could be
+  /// allocated.
+  [[nodiscard]] void* allocate(std::size_t size, std::size_t align) noexcept {
+    std::uintptr_t p = align_up(cur_, align);
+    if (cur_ == nullptr or p + size > reinterpret_cast<std::uintptr_t>(end_)) {
+      if (not grow(size, align))
+        return nullptr;
+      p = align_up(cur_, align);
+    }
+    cur_ = reinterpret_cast<std::byte*>(p + size);
+    return reinterpret_cast<void*>(p);
+  }
+
+  /// frees all blocks allocated by the arena and starts allocating from the
+  /// beginning of the user supplied buffer again. Objects allocated from the
+  /// arena must have been destroyed before.
+  void release() noexcept {
+    while (blocks_ != nullptr)
+      detail::mem_free(std::exchange(blocks_, blocks_->next));
+    cur_ = buffer_;
+    end_ = buffer_ + buffer_size_;
+  }
+
+  /// returns the arena of the calling thread. It is released when the thread
+  /// exits.
+  static arena& local() noexcept {
+    thread_local arena instance;
+    return instance;
+  }
+
+private:
+  struct block {
+    block* next;
+  };
+
+  static std::uintptr_t align_up(std::byte* p, std::size_t align) noexcept {
+    const auto addr = reinterpret_cast<std::uintptr_t>(p);
+    return (addr + align - 1) & ~(align - 1);
+  }
+
+  bool grow(std::size_t size, std::size_t align) noexcept {
+    const std::size_t needed = sizeof(block) + size + align;
+    const std::size_t bytes = needed > block_size_ ? needed : block_size_;
+    void* mem = detail::mem_alloc(bytes, alignof(block));
+    if (mem == nullptr)
+      return false;
+    blocks_ = ::new (mem) block{blocks_};
+    cur_ = static_cast<std::byte*>(mem) + sizeof(block);
+    end_ = static_cast<std::byte*>(mem) + bytes;
+    return true;
+  }
+
+  std::byte* cur_{nullptr};
+  std::byte* end_{nullptr};
+  block* blocks_{nullptr};
+  std::byte* buffer_{nullptr};
+  std::size_t buffer_size_{0};
+  std::size_t block_size_;
+};
+
+/// Allocator allocating from an arena. deallocate() does nothing, the memory
+/// is reclaimed when the arena is released. A default constructed
+/// arena_allocator allocates from the arena of the calling thread.
+template<typename T>
+class arena_allocator {
+public:
+  using value_type = T;
+
+  arena_allocator() noexcept : arena_(&arena::local()) {}
+
+  arena_allocator(arena& a) noexcept : arena_(&a) {}
+
+  template<typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept
+      : arena_(other.resource()) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) noexcept {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  /// returns the arena allocated from
+  arena* resource() const noexcept { return arena_; }
+
+private:
+  arena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const arena_allocator<T>& a,
+                const arena_allocator<U>& b) noexcept {
+  return a.resource() == b.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(const arena_allocator<T>& a,
+                const arena_allocator<U>& b) noexcept {
+  return a.resource() != b.resource();
+}
+
+/// Copyable storage with small buffer optimization, which allocates objects
+/// not fitting into its buffer from an arena. Destroying the storage destroys
+/// the object, but never frees memory. The arena is either passed to the
+/// constructor, or the arena of the calling thread.
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+using arena_storage =
+    sbo_storage<Size, Alignment, arena_allocator<std::byte>>;
+
+/// move only version of arena_storage
+template<std::size_t Size, std::size_t Alignment = alignof(std::max_align_t)>
+using move_only_arena_storage =
+    move_only_sbo_storage<Size, Alignment, arena_allocator<std::byte>>;
+} // namespace poly
+#endif
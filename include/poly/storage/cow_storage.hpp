@@ -0,0 +1,76 @@
+/**
+ * Copyright 2024 Pelé Constam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POLY_STORAGE_COW_STORAGE_HPP
+#define POLY_STORAGE_COW_STORAGE_HPP
+#include "poly/config.hpp"
+#include "poly/fwd.hpp"
+#include "poly/storage/shared_storage.hpp"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace poly {
+namespace detail {
+  template<bool Atomic>
+  class basic_cow_storage : public basic_shared_storage<Atomic> {
+    using base = basic_shared_storage<Atomic>;
+
+  public:
+    using base::base;
+
+    template<typename T, typename... Args>
+    T* emplace(Args&&... args) {
+      static_assert(std::is_copy_constructible_v<T>,
+                    "cow_storage requires copy constructible types");
+      return base::template emplace<T>(std::forward<Args>(args)...);
+    }
+
+    /// returns the object for modification. If the object is shared with
+    /// other storages, it is copied first, and the storage refers to the copy
+    /// afterwards.
+    /// @throws std::bad_alloc if the copy could not be allocated
+    void* data() {
+      if (this->block_ == nullptr)
+        return nullptr;
+      if (this->block_->count.get() != 1) {
+        shared_block<Atomic>* copy = this->block_->copy();
+        if (copy == nullptr)
+          throw std::bad_alloc{};
+        this->reset();
+        this->block_ = copy;
+      }
+      return this->block_->obj;
+    }
+
+    /// returns the shared object without copying it
+    const void* data() const noexcept { return base::data(); }
+  };
+} // namespace detail
+
+/// Copy on write storage. Copying the storage shares the object like
+/// shared_storage, but the object is copied as soon as it is accessed through
+/// the non const data() while other storages refer to it. Structs and
+/// Interfaces pass the object through the const data() when calling const
+/// methods or getting properties, so only calls of non const methods, setting
+/// properties or non const target() copy a shared object. The reference count
+/// is not atomic, use atomic_cow_storage for objects shared between threads.
+using cow_storage = detail::basic_cow_storage<false>;
+
+/// cow_storage with an atomic reference count.
+using atomic_cow_storage = detail::basic_cow_storage<true>;
+} // namespace poly
+#endif
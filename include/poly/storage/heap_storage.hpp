@@ -20,62 +20,69 @@
 #include "poly/fwd.hpp"
 #include "poly/traits.hpp"
 #include <cassert>
+#include <memory>
 
 namespace poly {
 namespace detail {
 
   /// heap_storage contains a pointer to a basic_heap_block.
   /// @{
-  template<bool Copyable>
+  template<bool Copyable, typename Allocator>
   struct basic_heap_block {
     void* obj{nullptr};
-    basic_heap_block* (*copy_)(const basic_heap_block*){nullptr};
-    void (*destroy_)(basic_heap_block*){nullptr};
-    basic_heap_block* copy() { return this->copy_(this); }
-    void destroy() { this->destroy_(this); }
+    basic_heap_block* (*copy_)(const basic_heap_block*,
+                               const Allocator&){nullptr};
+    basic_heap_block* (*move_)(basic_heap_block*, const Allocator&){nullptr};
+    void (*destroy_)(basic_heap_block*, const Allocator&){nullptr};
+    basic_heap_block* copy(const Allocator& alloc) const {
+      return this->copy_(this, alloc);
+    }
+    basic_heap_block* move(const Allocator& alloc) {
+      return this->move_(this, alloc);
+    }
+    void destroy(const Allocator& alloc) { this->destroy_(this, alloc); }
   };
-  template<>
-  struct basic_heap_block<false> {
+  template<typename Allocator>
+  struct basic_heap_block<false, Allocator> {
     void* obj{nullptr};
-    void (*destroy_)(basic_heap_block* obj){nullptr};
-    void destroy() { this->destroy_(this); }
+    basic_heap_block* (*move_)(basic_heap_block*, const Allocator&){nullptr};
+    void (*destroy_)(basic_heap_block*, const Allocator&){nullptr};
+    basic_heap_block* move(const Allocator& alloc) {
+      return this->move_(this, alloc);
+    }
+    void destroy(const Allocator& alloc) { this->destroy_(this, alloc); }
   };
 
   /// actual type allocated when using heap_storage.
   /// templated only on size and alignment of a type, as the destructor is
   /// stored in the basic_heap_block.
-  template<bool Copyable, std::size_t Size, std::size_t Align>
-  struct heap_block : basic_heap_block<Copyable> {
+  template<bool Copyable, typename Allocator, std::size_t Size,
+           std::size_t Align>
+  struct heap_block : basic_heap_block<Copyable, Allocator> {
+    using base = basic_heap_block<Copyable, Allocator>;
+
     constexpr heap_block() = default;
 
     template<typename T, typename... Args, bool C = Copyable,
              typename = std::enable_if_t<C>>
     heap_block(traits::Id<T>, Args&&... args) noexcept(
         std::is_nothrow_constructible_v<T, Args&&...>)
-        : basic_heap_block<Copyable>{
-              nullptr,
-              +[](const basic_heap_block<Copyable>* o)
-                  -> basic_heap_block<Copyable>* {
-                assert(o);
-                const auto* block = static_cast<const heap_block*>(o);
-                // allocating memory
-                void* mem = mem_alloc(sizeof(heap_block), alignof(heap_block));
-                // default construction of heap_blcok into allcoateds memory
-                auto* ret = poly::detail::construct_at(
-                    reinterpret_cast<heap_block*>(mem));
-                // reassign data members
-                ret->copy_ = block->copy_;
-                ret->destroy_ = block->destroy_;
-                // copying the T in buffer
-                ret->obj = poly::detail::construct_at(
-                    reinterpret_cast<T*>(ret->buffer),
-                    *reinterpret_cast<const T*>(block->buffer));
-                return ret;
-              },
-              +[](basic_heap_block<Copyable>* o) {
-                std::destroy_at(static_cast<T*>(o->obj));
-                mem_free(o);
-              }} {
+        : base{nullptr,
+               +[](const base* o, const Allocator& alloc) -> base* {
+                 assert(o);
+                 return allocate_with<heap_block>(
+                     alloc, traits::Id<T>{}, *static_cast<const T*>(o->obj));
+               },
+               +[](base* o, const Allocator& alloc) -> base* {
+                 assert(o);
+                 return allocate_with<heap_block>(
+                     alloc, traits::Id<T>{},
+                     std::move(*static_cast<T*>(o->obj)));
+               },
+               +[](base* o, const Allocator& alloc) {
+                 std::destroy_at(static_cast<T*>(o->obj));
+                 deallocate_with(alloc, static_cast<heap_block*>(o));
+               }} {
       this->obj = poly::detail::construct_at(reinterpret_cast<T*>(buffer),
                                              std::forward<Args>(args)...);
     }
@@ -84,11 +91,17 @@ namespace detail {
              typename = std::enable_if_t<NC>>
     heap_block(traits::Id<T>, Args&&... args) noexcept(
         std::is_nothrow_constructible_v<T, Args&&...>)
-        : basic_heap_block<Copyable>{nullptr,
-                                     +[](basic_heap_block<Copyable>* o) {
-                                       std::destroy_at(static_cast<T*>(o->obj));
-                                       mem_free(o);
-                                     }} {
+        : base{nullptr,
+               +[](base* o, const Allocator& alloc) -> base* {
+                 assert(o);
+                 return allocate_with<heap_block>(
+                     alloc, traits::Id<T>{},
+                     std::move(*static_cast<T*>(o->obj)));
+               },
+               +[](base* o, const Allocator& alloc) {
+                 std::destroy_at(static_cast<T*>(o->obj));
+                 deallocate_with(alloc, static_cast<heap_block*>(o));
+               }} {
       this->obj = poly::detail::construct_at(reinterpret_cast<T*>(buffer),
                                              std::forward<Args>(args)...);
     }
@@ -96,28 +109,34 @@ namespace detail {
     alignas(Align) std::byte buffer[Size]{};
   };
 
-  /// allocates a heap_block for a T and constructs it with args.
-  template<bool Copyable, typename T, typename... Args>
-  basic_heap_block<Copyable>* allocate_block(
-      traits::Id<T> id,
-      Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
-    using block = heap_block<Copyable, sizeof(T), alignof(T)>;
-    void* mem = mem_alloc(sizeof(block), alignof(block));
-    if (mem == nullptr)
-      return nullptr;
-    return ::new (mem) block(id, std::forward<Args>(args)...);
+  /// allocates a heap_block for a T with alloc and constructs it with args.
+  template<bool Copyable, typename T, typename Allocator, typename... Args>
+  basic_heap_block<Copyable, Allocator>*
+  allocate_block(const Allocator& alloc, traits::Id<T> id, Args&&... args) {
+    using block = heap_block<Copyable, Allocator, sizeof(T), alignof(T)>;
+    return allocate_with<block>(alloc, id, std::forward<Args>(args)...);
   }
 
-  template<bool Copyable>
+  template<bool Copyable, typename Allocator>
   class basic_heap_storage {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
   public:
+    using allocator_type = Allocator;
+
     constexpr basic_heap_storage() noexcept = default;
 
+    /// construct empty storage which allocates with alloc
+    explicit constexpr basic_heap_storage(const Allocator& alloc) noexcept
+        : alloc_(alloc) {}
+
     basic_heap_storage(const basic_heap_storage& other)
-        : block_(other.block_ ? other.block_->copy() : nullptr) {}
+        : alloc_(alloc_traits::select_on_container_copy_construction(
+              other.alloc_)),
+          block_(other.block_ ? other.block_->copy(alloc_) : nullptr) {}
 
     basic_heap_storage(basic_heap_storage&& other) noexcept
-        : block_(std::exchange(other.block_, nullptr)) {}
+        : alloc_(other.alloc_), block_(std::exchange(other.block_, nullptr)) {}
 
     ~basic_heap_storage() { reset(); }
 
@@ -125,22 +144,39 @@ namespace detail {
       if (this == &other)
         return *this;
       reset();
-      block_ = other.block_ ? other.block_->copy() : nullptr;
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::
+                        value)
+        alloc_ = other.alloc_;
+      block_ = other.block_ ? other.block_->copy(alloc_) : nullptr;
       return *this;
     }
 
-    basic_heap_storage& operator=(basic_heap_storage&& other) noexcept {
+    basic_heap_storage& operator=(basic_heap_storage&& other) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value or
+        alloc_traits::is_always_equal::value) {
       if (this == &other)
         return *this;
-      std::swap(block_, other.block_);
-      other.reset();
+      reset();
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                        value)
+        alloc_ = other.alloc_;
+      if (not other.block_)
+        return *this;
+      if (same_allocator(other)) {
+        block_ = std::exchange(other.block_, nullptr);
+      } else {
+        // the memory of other can not be freed with this allocator, move the
+        // object into a new block instead.
+        block_ = other.block_->move(alloc_);
+        other.reset();
+      }
       return *this;
     }
 
     template<typename T, typename... Args>
     T* emplace(Args&&... args) {
       reset();
-      block_ = detail::allocate_block<Copyable>(traits::Id<T>{},
+      block_ = detail::allocate_block<Copyable>(alloc_, traits::Id<T>{},
                                                 std::forward<Args>(args)...);
       return block_ ? static_cast<T*>(block_->obj) : nullptr;
     }
@@ -148,19 +184,42 @@ namespace detail {
     void* data() noexcept { return block_ ? block_->obj : nullptr; }
     const void* data() const noexcept { return block_ ? block_->obj : nullptr; }
 
+    /// returns a copy of the allocator used to allocate objects.
+    Allocator get_allocator() const noexcept { return alloc_; }
+
   private:
     void reset() noexcept {
       if (block_ == nullptr)
         return;
-      block_->destroy(); // also deallocates block itself
+      block_->destroy(alloc_); // also deallocates block itself
       block_ = nullptr;
     }
-    using block = detail::basic_heap_block<Copyable>;
+
+    bool same_allocator(const basic_heap_storage& other) const noexcept {
+      if constexpr (alloc_traits::is_always_equal::value)
+        return true;
+      else
+        return alloc_ == other.alloc_;
+    }
+
+    using block = detail::basic_heap_block<Copyable, Allocator>;
+    POLY_NO_UNIQUE_ADDRESS Allocator alloc_{};
     block* block_{nullptr};
   };
 
 } // namespace detail
-using heap_storage = detail::basic_heap_storage<true>;
-using move_only_heap_storage = detail::basic_heap_storage<false>;
+
+/// storage which allocates every object with Allocator. Allocator may be any
+/// standard conforming allocator, e.g. std::pmr::polymorphic_allocator.
+template<typename Allocator>
+using allocator_heap_storage = detail::basic_heap_storage<true, Allocator>;
+/// move only version of allocator_heap_storage.
+template<typename Allocator>
+using move_only_allocator_heap_storage =
+    detail::basic_heap_storage<false, Allocator>;
+
+using heap_storage = allocator_heap_storage<allocator<std::byte>>;
+using move_only_heap_storage =
+    move_only_allocator_heap_storage<allocator<std::byte>>;
 } // namespace poly
 #endif
@@ -18,25 +18,33 @@
 #include "poly/alloc.hpp"
 #include "poly/config.hpp"
 #include "poly/fwd.hpp"
+#include "poly/traits.hpp"
 
+#include <cstring>
+#include <type_traits>
 #include <utility>
 
 namespace poly {
 namespace detail {
-  /// table of function pointers for resource management used by local_storage
+  /// table of function pointers for resource management used by local_storage.
+  /// copy is nullptr for trivially copyable types, which are copied with
+  /// memcpy, and destroy is nullptr for trivially destructible types.
   template<bool Copyable>
   struct resource_table {
     void (*copy)(void* dest, const void* src);
     void (*move)(void* dest, void* src);
     void (*destroy)(void* dest);
+    bool relocatable; ///< true if the object may be moved with memcpy
   };
 
   /// table of function pointers for resource management used by
-  /// local_move_only_storage
+  /// local_move_only_storage. destroy is nullptr for trivially destructible
+  /// types.
   template<>
   struct resource_table<false> {
     void (*move)(void* dest, void* src);
     void (*destroy)(void* dest);
+    bool relocatable; ///< true if the object may be moved with memcpy
   };
 
   /// returns a fully populated resource_table
@@ -45,17 +53,23 @@ namespace detail {
     if constexpr (Copyable) {
       return resource_table<true>{
           //.copy =
-          +[](void* dest, const void* src) {
-            poly::detail::construct_at(static_cast<T*>(dest),
-                                       *static_cast<const T*>(src));
-          },
+          std::is_trivially_copyable_v<T>
+              ? nullptr
+              : +[](void* dest, const void* src) {
+                  poly::detail::construct_at(static_cast<T*>(dest),
+                                             *static_cast<const T*>(src));
+                },
           //.move =
           +[](void* dest, void* src) {
             poly::detail::construct_at(static_cast<T*>(dest),
                                        std::move(*static_cast<T*>(src)));
           },
           //.destroy =
-          +[](void* src) { std::destroy_at(static_cast<T*>(src)); }};
+          std::is_trivially_destructible_v<T>
+              ? nullptr
+              : +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
+          //.relocatable =
+          is_trivially_relocatable_v<T>};
     } else {
       return resource_table<false>{
           //.move =
@@ -64,7 +78,11 @@ namespace detail {
                                        std::move(*static_cast<T*>(src)));
           },
           //.destroy =
-          +[](void* src) { std::destroy_at(static_cast<T*>(src)); }};
+          std::is_trivially_destructible_v<T>
+              ? nullptr
+              : +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
+          //.relocatable =
+          is_trivially_relocatable_v<T>};
     }
   }
 
@@ -151,7 +169,7 @@ namespace detail {
       static_assert(alignof(T) <= Alignment,
                     "The alignment of T is to large to fit into this");
       reset();
-      T* ret = poly::detail::construct_at(static_cast<T*>(buffer_),
+      T* ret = poly::detail::construct_at(this->as<T>(),
                                           std::forward<Args>(args)...);
       if (!ret)
         return nullptr;
@@ -173,7 +191,8 @@ namespace detail {
     /// destroy the contained object
     constexpr void reset() {
       if (vtbl_) {
-        vtbl_->destroy(buffer_);
+        if (vtbl_->destroy)
+          vtbl_->destroy(buffer_);
         vtbl_ = nullptr;
       }
     }
@@ -206,6 +225,14 @@ namespace detail {
       reset();
       if (other.vtbl_ == nullptr)
         return *this;
+      // memcpy cannot be used in constant expressions, move the object there
+      if (other.vtbl_->relocatable and not std::is_constant_evaluated()) {
+        // copy the whole buffer of other, its size is known at compile time.
+        // other gives up the object without destroying it.
+        std::memcpy(buffer_, other.buffer_, S);
+        vtbl_ = std::exchange(other.vtbl_, nullptr);
+        return *this;
+      }
       other.vtbl_->move(buffer_, other.buffer_);
       vtbl_ = other.vtbl_;
       other.reset();
@@ -231,7 +258,10 @@ namespace detail {
       reset();
       if (other.vtbl_ == nullptr)
         return *this;
-      other.vtbl_->copy(buffer_, other.buffer_);
+      if (other.vtbl_->copy)
+        other.vtbl_->copy(buffer_, other.buffer_);
+      else
+        std::memcpy(buffer_, other.buffer_, S);
       vtbl_ = other.vtbl_;
       return *this;
     }
@@ -18,7 +18,9 @@
 #include "poly/alloc.hpp"
 #include "poly/config.hpp"
 #include "poly/fwd.hpp"
+#include "poly/traits.hpp"
 
+#include <cstring>
 #include <memory>
 
 namespace poly {
@@ -33,49 +35,63 @@ namespace detail {
     alignas(Align) std::byte buffer[Size];
   };
 
-  /// table of function pointers for resource managment used by sbo_storage
-  template<bool Copyable>
+  /// table of function pointers for resource managment used by sbo_storage.
+  /// The heap functions allocate and free with the allocator of the storage.
+  template<bool Copyable, typename Allocator>
   struct sbo_resource_table {
     void (*copy)(void* dest,
-                 const void* src); ///< copy from one local buffer to another
-    void* (*heap_copy)(const void* src); ///< allocates new heap copy
+                 const void* src); ///< copy from one local buffer to another,
+                                   ///< nullptr if T is trivially copyable
+    void* (*heap_copy)(const void* src,
+                       const Allocator& alloc); ///< allocates new heap copy
     void (*move)(void* dest,
                  void* src); ///< move from one local buffer to another
-    void* (*heap_move)(
-        void* src); ///< allocates new heap copy move constructed from src
-    void (*destroy)(void* dest);      ///< destroy object in local buffer
-    void (*heap_destroy)(void* dest); ///< destroy object on heap
+    void* (*heap_move)(void* src,
+                       const Allocator& alloc); ///< allocates new heap copy
+                                                ///< move constructed from src
+    void (*destroy)(void* dest); ///< destroy object in local buffer, nullptr
+                                 ///< if T is trivially destructible
+    void (*heap_destroy)(void* dest,
+                         const Allocator& alloc); ///< destroy object on heap
     std::size_t size;
     std::size_t align;
+    bool relocatable; ///< true if the object may be moved with memcpy
   };
 
   /// table of function pointers for resource managment used by
   /// sbo_move_only_storage
-  template<>
-  struct sbo_resource_table<false> {
+  template<typename Allocator>
+  struct sbo_resource_table<false, Allocator> {
     void (*move)(void* dest,
                  void* src); ///< move from one local buffer to another
-    void* (*heap_move)(
-        void* src); ///< allocates new heap copy move constructed from src
-    void (*destroy)(void* dest);      ///< destroy object in local buffer
-    void (*heap_destroy)(void* dest); ///< destroy object on heap
+    void* (*heap_move)(void* src,
+                       const Allocator& alloc); ///< allocates new heap copy
+                                                ///< move constructed from src
+    void (*destroy)(void* dest); ///< destroy object in local buffer, nullptr
+                                 ///< if T is trivially destructible
+    void (*heap_destroy)(void* dest,
+                         const Allocator& alloc); ///< destroy object on heap
     std::size_t size;
     std::size_t align;
+    bool relocatable; ///< true if the object may be moved with memcpy
   };
 
   /// returns a fully populated sbo_resource_table
-  template<bool Copyable, typename T>
-  constexpr sbo_resource_table<Copyable> get_sbo_resource_table() noexcept {
+  template<bool Copyable, typename Allocator, typename T>
+  constexpr sbo_resource_table<Copyable, Allocator>
+  get_sbo_resource_table() noexcept {
     if constexpr (Copyable) {
-      return sbo_resource_table<true>{
+      return sbo_resource_table<true, Allocator>{
           // .copy =
-          +[](void* dest, const void* src) {
-            poly::detail::construct_at(static_cast<T*>(dest),
-                                       *static_cast<const T*>(src));
-          },
+          std::is_trivially_copyable_v<T>
+              ? nullptr
+              : +[](void* dest, const void* src) {
+                  poly::detail::construct_at(static_cast<T*>(dest),
+                                             *static_cast<const T*>(src));
+                },
           // .heap_copy =
-          +[](const void* src) -> void* {
-            return allocate<T>(*static_cast<const T*>(src));
+          +[](const void* src, const Allocator& alloc) -> void* {
+            return allocate_with<T>(alloc, *static_cast<const T*>(src));
           },
           // .move =
           +[](void* dest, void* src) {
@@ -83,70 +99,117 @@ namespace detail {
                                        std::move(*static_cast<T*>(src)));
           },
           // .heap_move =
-          +[](void* src) -> void* {
-            return allocate<T>(std::move(*static_cast<T*>(src)));
+          +[](void* src, const Allocator& alloc) -> void* {
+            return allocate_with<T>(alloc, std::move(*static_cast<T*>(src)));
           },
           // .destroy =
-          +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
+          std::is_trivially_destructible_v<T>
+              ? nullptr
+              : +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
           // .heap_destroy =
-          +[](void* src) { deallocate(static_cast<T*>(src)); },
+          +[](void* src, const Allocator& alloc) {
+            deallocate_with(alloc, static_cast<T*>(src));
+          },
           // .size =
           sizeof(T),
           // .align =
-          alignof(T)};
+          alignof(T),
+          // .relocatable =
+          is_trivially_relocatable_v<T>};
     } else {
-      return sbo_resource_table<false>{
+      return sbo_resource_table<false, Allocator>{
           // .move =
           +[](void* dest, void* src) {
             poly::detail::construct_at(static_cast<T*>(dest),
                                        std::move(*static_cast<T*>(src)));
           },
           // .heap_move =
-          +[](void* src) -> void* {
-            return allocate<T>(std::move(*static_cast<T*>(src)));
+          +[](void* src, const Allocator& alloc) -> void* {
+            return allocate_with<T>(alloc, std::move(*static_cast<T*>(src)));
           },
           // .destroy =
-          +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
+          std::is_trivially_destructible_v<T>
+              ? nullptr
+              : +[](void* src) { std::destroy_at(static_cast<T*>(src)); },
           // .heap_destroy =
-          +[](void* src) { deallocate(static_cast<T*>(src)); },
+          +[](void* src, const Allocator& alloc) {
+            deallocate_with(alloc, static_cast<T*>(src));
+          },
           // .size =
           sizeof(T),
           // .align =
-          alignof(T)};
+          alignof(T),
+          // .relocatable =
+          is_trivially_relocatable_v<T>};
     }
   }
 
-  template<bool Copyable, typename T>
-  inline constexpr sbo_resource_table<Copyable> sbo_table_for =
-      get_sbo_resource_table<Copyable, T>();
+  template<bool Copyable, typename Allocator, typename T>
+  inline constexpr sbo_resource_table<Copyable, Allocator> sbo_table_for =
+      get_sbo_resource_table<Copyable, Allocator, T>();
+
+  /// pointer to the object of a basic_sbo_storage with CacheObject set to
+  /// true, either into its buffer or to the heap. Empty otherwise.
+  /// @{
+  template<bool CacheObject>
+  struct sbo_object_pointer {};
+  template<>
+  struct sbo_object_pointer<true> {
+    void* ptr{nullptr};
+  };
+  /// @}
+
   /// storage with small buffer optimization implementation.
   ///
   /// Emplaced objects are allocated within a buffer of Size with alignment
   /// Alignment if the object satisfies these constraints, else the object is
-  /// heap allocated.
+  /// allocated with Allocator.
   /// @tparam Copyable specify if the storage is copyable
   /// @tparam Size  size of the internal buffer in bytes
   /// @tparam Alignment alignment of internal buffer in bytes
-  template<bool Copyable, std::size_t Size, std::size_t Alignment>
+  /// @tparam Allocator allocator used for objects which do not fit into the
+  /// buffer
+  /// @tparam CacheObject if true, the storage keeps a pointer to its object,
+  /// so that accessing the object does not have to load the size and
+  /// alignment from the resource table to find out where the object lives.
+  template<bool Copyable, std::size_t Size, std::size_t Alignment,
+           typename Allocator, bool CacheObject>
   class basic_sbo_storage {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    /// storage of the same kind with a buffer of different size and alignment
+    template<std::size_t S, std::size_t A>
+    using sibling = basic_sbo_storage<Copyable, S, A, Allocator, CacheObject>;
+
   public:
-    template<bool C, std::size_t S, std::size_t A>
+    template<bool C, std::size_t S, std::size_t A, typename Al, bool O>
     friend class basic_sbo_storage;
-    template<std::size_t S, std::size_t A>
+    template<std::size_t S, std::size_t A, typename Al>
     friend class sbo_storage;
+    template<std::size_t S, std::size_t A, typename Al>
+    friend class cached_sbo_storage;
+
+    using allocator_type = Allocator;
 
     constexpr basic_sbo_storage() noexcept {}
 
+    /// construct empty storage which allocates with alloc
+    explicit constexpr basic_sbo_storage(const Allocator& alloc) noexcept
+        : alloc_(alloc) {}
+
     /// copy ctor for copyable sbo storage
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage(
-        const basic_sbo_storage<Copyable, S, A>& other) {
+    constexpr basic_sbo_storage(const sibling<S, A>& other)
+        : alloc_(alloc_traits::select_on_container_copy_construction(
+              other.alloc_)) {
       static_assert(Copyable);
       this->copy(other);
     }
 
     /// copy ctor for copyable sbo storage
-    constexpr basic_sbo_storage(const basic_sbo_storage& other) {
+    constexpr basic_sbo_storage(const basic_sbo_storage& other)
+        : alloc_(alloc_traits::select_on_container_copy_construction(
+              other.alloc_)) {
       /// this definition is needed, else the compiler produces a memcpy for the
       /// copy ctor instead of choosing the template version
       static_assert(Copyable);
@@ -155,39 +218,39 @@ namespace detail {
 
     /// move ctor
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage(basic_sbo_storage<Copyable, S, A>&& other) {
+    constexpr basic_sbo_storage(sibling<S, A>&& other)
+        : alloc_(other.alloc_) {
       this->move(std::move(other));
     }
 
     /// move ctor
-    constexpr basic_sbo_storage(basic_sbo_storage&& other) {
+    constexpr basic_sbo_storage(basic_sbo_storage&& other)
+        : alloc_(other.alloc_) {
       this->move(std::move(other));
     }
 
     /// move assignment
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage&
-    operator=(basic_sbo_storage<Copyable, S, A>&& other) {
-      return this->move(std::move(other));
+    constexpr basic_sbo_storage& operator=(sibling<S, A>&& other) {
+      return this->move_assign(std::move(other));
     }
 
     /// move assignment
     constexpr basic_sbo_storage& operator=(basic_sbo_storage&& other) {
-      return this->move(std::move(other));
+      return this->move_assign(std::move(other));
     }
 
     /// copy assignment
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage&
-    operator=(const basic_sbo_storage<Copyable, S, A>& other) {
+    constexpr basic_sbo_storage& operator=(const sibling<S, A>& other) {
       static_assert(Copyable);
-      return this->copy(other);
+      return this->copy_assign(other);
     }
 
     /// copy assignment
     constexpr basic_sbo_storage& operator=(const basic_sbo_storage& other) {
       static_assert(Copyable);
-      return this->copy(other);
+      return this->copy_assign(other);
     }
 
     POLY_CONSTEXPR ~basic_sbo_storage() { reset(); }
@@ -195,7 +258,7 @@ namespace detail {
     /// create a T with arguments args by either
     /// - in place constructing the T with placment new inside the local
     /// buffer is sizeof(T) <= Size and alignof(T) = Alignment, or
-    /// - allocating the T on the heap with operator new if T does not fit
+    /// - allocating the T with the allocator of the storage if T does not fit
     /// inside the local buffer
     ///
     /// @tparam T type to store
@@ -213,40 +276,95 @@ namespace detail {
         if (!ret)
           return nullptr;
       } else {
-        ret = allocate<T>(std::forward<Args>(args)...);
+        ret = allocate_with<T>(alloc_, std::forward<Args>(args)...);
         if (!ret)
           return nullptr;
         buffer.heap = ret;
       }
-      vtbl_ = &sbo_table_for<Copyable, T>;
+      vtbl_ = &sbo_table_for<Copyable, Allocator, T>;
+      set_object(ret);
       return ret;
     }
 
     /// get pointer to contained object, or nullptr if no object was emplaced.
     constexpr void* data() noexcept {
-      return this->contains_value() ? this->as<void>() : nullptr;
+      if constexpr (CacheObject)
+        return obj_.ptr;
+      else
+        return this->contains_value() ? this->as<void>() : nullptr;
     }
 
     /// get pointer to contained object, or nullptr if no object was emplaced.
     constexpr const void* data() const noexcept {
-      return this->contains_value() ? this->as<const void>() : nullptr;
+      if constexpr (CacheObject)
+        return obj_.ptr;
+      else
+        return this->contains_value() ? this->as<const void>() : nullptr;
     }
 
+    /// returns a copy of the allocator used for heap allocated objects.
+    constexpr Allocator get_allocator() const noexcept { return alloc_; }
+
   private:
     constexpr void reset() {
       if (not this->contains_value())
         return;
 
-      if (vtbl_->size > Size or vtbl_->align > Alignment)
-        vtbl_->heap_destroy(buffer.heap);
-      else
+      if (is_heap_allocated())
+        vtbl_->heap_destroy(buffer.heap, alloc_);
+      else if (vtbl_->destroy)
         vtbl_->destroy(buffer.buffer);
       vtbl_ = nullptr;
+      set_object(nullptr);
     }
 
+    /// records the location of the object, if CacheObject is set. Must be
+    /// called whenever an object is placed into or removed from the storage.
+    constexpr void set_object(void* obj) noexcept {
+      if constexpr (CacheObject)
+        obj_.ptr = obj;
+    }
+
+    /// true if memory allocated by others allocator can be freed with this
+    /// storages allocator.
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage&
-    move(basic_sbo_storage<Copyable, S, A>&& other) {
+    constexpr bool same_allocator(const sibling<S, A>& other) const {
+      if constexpr (alloc_traits::is_always_equal::value)
+        return true;
+      else
+        return alloc_ == other.alloc_;
+    }
+
+    template<std::size_t S, std::size_t A>
+    constexpr basic_sbo_storage& move_assign(sibling<S, A>&& other) {
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                        value) {
+        if constexpr (S == Size and A == Alignment) {
+          if (&other == this)
+            return *this;
+        }
+        reset();
+        alloc_ = other.alloc_;
+      }
+      return this->move(std::move(other));
+    }
+
+    template<std::size_t S, std::size_t A>
+    constexpr basic_sbo_storage& copy_assign(const sibling<S, A>& other) {
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::
+                        value) {
+        if constexpr (S == Size and A == Alignment) {
+          if (&other == this)
+            return *this;
+        }
+        reset();
+        alloc_ = other.alloc_;
+      }
+      return this->copy(other);
+    }
+
+    template<std::size_t S, std::size_t A>
+    constexpr basic_sbo_storage& move(sibling<S, A>&& other) {
       if constexpr (S == Size and A == Alignment) {
         if (&other == this)
           return *this;
@@ -257,6 +375,17 @@ namespace detail {
         return *this;
       }
 
+      if (other.vtbl_->relocatable and not other.is_heap_allocated() and
+          other.vtbl_->size <= Size and other.vtbl_->align <= Alignment) {
+        // copy the buffer of other bytewise, the number of bytes is known at
+        // compile time. other gives up the object without destroying it.
+        std::memcpy(buffer.buffer, other.buffer.buffer, S < Size ? S : Size);
+        vtbl_ = std::exchange(other.vtbl_, nullptr);
+        set_object(buffer.buffer);
+        other.set_object(nullptr);
+        return *this;
+      }
+
       if (other.vtbl_->size <= Size and other.vtbl_->align <= Alignment) {
         // others object fits into this small buffer
         if (other.is_heap_allocated()) {
@@ -270,29 +399,33 @@ namespace detail {
         // others vtable is not touched to ensure proper destruction
         // of others object on heap
         vtbl_ = other.vtbl_;
+        set_object(buffer.buffer);
       } else {
         // others object does not fit into this small buffer
-        if (other.is_heap_allocated()) {
+        if (other.is_heap_allocated() and same_allocator(other)) {
           // simply copy pointers and set others to null
           buffer.heap = other.buffer.heap;
           vtbl_ = other.vtbl_;
           other.buffer.heap = nullptr;
           other.vtbl_ = nullptr; // manual reset without dtor
+          other.set_object(nullptr);
         } else {
-          // move object from others bufffer into heap, copy vtable.
+          // move object from others bufffer or from memory owned by others
+          // allocator into memory owned by this allocator, copy vtable.
           // others vtable is not touched to ensure proper destruction
-          // of others object in buffer
-          buffer.heap = other.vtbl_->heap_move(other.buffer.buffer);
+          // of others object
+          buffer.heap =
+              other.vtbl_->heap_move(other.template as<void>(), alloc_);
           vtbl_ = other.vtbl_;
         }
+        set_object(buffer.heap);
       }
       other.reset();
       return *this;
     }
 
     template<std::size_t S, std::size_t A>
-    constexpr basic_sbo_storage&
-    copy(const basic_sbo_storage<Copyable, S, A>& other) {
+    constexpr basic_sbo_storage& copy(const sibling<S, A>& other) {
       static_assert(Copyable);
       if constexpr (S == Size and A == Alignment) {
         if (&other == this)
@@ -306,22 +439,28 @@ namespace detail {
 
       if (other.vtbl_->size <= Size and other.vtbl_->align <= Alignment) {
         // others object fits into this small buffer
-        if (other.is_heap_allocated()) {
+        if (other.vtbl_->copy == nullptr) {
+          // trivially copyable, copy the bytes of the object
+          std::memcpy(buffer.buffer, other.template as<const void>(),
+                      other.vtbl_->size);
+        } else if (other.is_heap_allocated()) {
           // copy others heap object into this buffer
           other.vtbl_->copy(buffer.buffer, other.buffer.heap);
         } else {
           // copy others buffer object into this buffer
           other.vtbl_->copy(buffer.buffer, other.buffer.buffer);
         }
+        set_object(buffer.buffer);
       } else {
         // others object does not fit into small buffer
         if (other.is_heap_allocated()) {
           // heap copy
-          buffer.heap = other.vtbl_->heap_copy(other.buffer.heap);
+          buffer.heap = other.vtbl_->heap_copy(other.buffer.heap, alloc_);
         } else {
           // heap copy
-          buffer.heap = other.vtbl_->heap_copy(other.buffer.buffer);
+          buffer.heap = other.vtbl_->heap_copy(other.buffer.buffer, alloc_);
         }
+        set_object(buffer.heap);
       }
       vtbl_ = other.vtbl_;
       return *this;
@@ -330,6 +469,9 @@ namespace detail {
     constexpr bool contains_value() const noexcept { return vtbl_ != nullptr; }
 
     constexpr bool is_heap_allocated() const noexcept {
+      if constexpr (CacheObject)
+        return obj_.ptr != nullptr and
+               obj_.ptr != static_cast<const void*>(buffer.buffer);
       if (not contains_value())
         return false;
       if (vtbl_->size > Size or vtbl_->align > Alignment)
@@ -339,6 +481,8 @@ namespace detail {
 
     template<typename T>
     constexpr T* as() noexcept {
+      if constexpr (CacheObject)
+        return static_cast<T*>(obj_.ptr);
       if (vtbl_->size <= Size and vtbl_->align <= Alignment)
         return static_cast<T*>(static_cast<void*>(buffer.buffer));
       return static_cast<T*>(buffer.heap);
@@ -346,12 +490,16 @@ namespace detail {
 
     template<typename T>
     constexpr const T* as() const noexcept {
+      if constexpr (CacheObject)
+        return static_cast<const T*>(obj_.ptr);
       if (vtbl_->size <= Size and vtbl_->align <= Alignment)
         return static_cast<const T*>(static_cast<const void*>(buffer.buffer));
       return static_cast<const T*>(buffer.heap);
     }
 
-    const detail::sbo_resource_table<Copyable>* vtbl_{nullptr};
+    POLY_NO_UNIQUE_ADDRESS Allocator alloc_{};
+    const detail::sbo_resource_table<Copyable, Allocator>* vtbl_{nullptr};
+    POLY_NO_UNIQUE_ADDRESS sbo_object_pointer<CacheObject> obj_{};
     detail::raw_sbo_storage<Size, Alignment> buffer;
   };
 
@@ -360,37 +508,47 @@ namespace detail {
 /// Copyable storage with small buffer optimization.
 ///
 /// Emplaced objects are allocated within a buffer of Size with alignment
-/// Alignment if the object satisfies these constraints, else it is heap
-/// allocated.
+/// Alignment if the object satisfies these constraints, else it is allocated
+/// with Allocator. Allocator may be any standard conforming allocator, e.g.
+/// std::pmr::polymorphic_allocator<std::byte>.
 /// @tparam Size  size of the internal buffer in bytes
 /// @tparam Alignment alignment of internal buffer in bytes
-template<std::size_t Size, std::size_t Alignment>
+/// @tparam Allocator allocator for objects which do not fit into the buffer.
+/// Defaults to poly::allocator<std::byte>.
+template<std::size_t Size, std::size_t Alignment, typename Allocator>
 class sbo_storage final
-    : public detail::basic_sbo_storage<true, Size, Alignment> {
+    : public detail::
+          basic_sbo_storage<true, Size, Alignment, Allocator, false> {
 public:
-  template<std::size_t S, std::size_t A>
+  template<std::size_t S, std::size_t A, typename Al>
   friend class sbo_storage;
 
-  using Base = detail::basic_sbo_storage<true, Size, Alignment>;
+  using Base =
+      detail::basic_sbo_storage<true, Size, Alignment, Allocator, false>;
   using Base::data;
   using Base::emplace;
 
   /// construct empty storage
   constexpr sbo_storage() noexcept : Base() {}
 
+  /// construct empty storage which allocates with alloc
+  explicit constexpr sbo_storage(const Allocator& alloc) noexcept
+      : Base(alloc) {}
+
   /// move ctor
   template<std::size_t S, std::size_t A>
-  constexpr sbo_storage(sbo_storage<S, A>&& s) : Base(std::move(s)) {}
+  constexpr sbo_storage(sbo_storage<S, A, Allocator>&& s)
+      : Base(std::move(s)) {}
   constexpr sbo_storage(sbo_storage&& s) : Base(std::move(s)) {}
 
   /// copy ctor
   constexpr sbo_storage(const sbo_storage& s) : Base(s) {}
   template<std::size_t S, std::size_t A>
-  constexpr sbo_storage(const sbo_storage<S, A>& s) : Base(s) {}
+  constexpr sbo_storage(const sbo_storage<S, A, Allocator>& s) : Base(s) {}
 
   /// move assignemnt
   template<std::size_t S, std::size_t A>
-  constexpr sbo_storage& operator=(sbo_storage<S, A>&& s) {
+  constexpr sbo_storage& operator=(sbo_storage<S, A, Allocator>&& s) {
     Base::operator=(std::move(s));
     return *this;
   }
@@ -401,7 +559,7 @@ public:
     return *this;
   }
   template<std::size_t S, std::size_t A>
-  constexpr sbo_storage& operator=(const sbo_storage<S, A>& s) {
+  constexpr sbo_storage& operator=(const sbo_storage<S, A, Allocator>& s) {
     Base::operator=(s);
     return *this;
   }
@@ -410,20 +568,28 @@ public:
 /// Move only storage with small buffer optimization.
 ///
 /// Emplaced objects are allocated within a buffer of Size with alignment
-/// Alignment if the object satisfies these constraints, else it is heap
-/// allocated.
+/// Alignment if the object satisfies these constraints, else it is allocated
+/// with Allocator.
 /// @tparam Size  size of the internal buffer in bytes
 /// @tparam Alignment alignment of internal buffer in bytes
-template<std::size_t Size, std::size_t Alignment>
+/// @tparam Allocator allocator for objects which do not fit into the buffer.
+/// Defaults to poly::allocator<std::byte>.
+template<std::size_t Size, std::size_t Alignment, typename Allocator>
 class move_only_sbo_storage final
-    : public detail::basic_sbo_storage<false, Size, Alignment> {
+    : public detail::
+          basic_sbo_storage<false, Size, Alignment, Allocator, false> {
 public:
-  using Base = detail::basic_sbo_storage<false, Size, Alignment>;
+  using Base =
+      detail::basic_sbo_storage<false, Size, Alignment, Allocator, false>;
   using Base::data;
   using Base::emplace;
   /// construct empty storage
   constexpr move_only_sbo_storage() noexcept : Base() {}
 
+  /// construct empty storage which allocates with alloc
+  explicit constexpr move_only_sbo_storage(const Allocator& alloc) noexcept
+      : Base(alloc) {}
+
   /// construct with a T
   // template <typename T, typename = std::enable_if_t<
   //                           not poly::is_storage_v<std::decay_t<T>>>>
@@ -433,7 +599,7 @@ public:
 
   /// move ctor
   template<std::size_t S, std::size_t A>
-  constexpr move_only_sbo_storage(move_only_sbo_storage<S, A>&& s)
+  constexpr move_only_sbo_storage(move_only_sbo_storage<S, A, Allocator>&& s)
       : Base(std::move(s)) {}
 
   /// deleted copy ctor
@@ -445,7 +611,8 @@ public:
   //   return *this;
   // }
   template<std::size_t S, std::size_t A>
-  constexpr move_only_sbo_storage& operator=(move_only_sbo_storage<S, A>&& s) {
+  constexpr move_only_sbo_storage&
+  operator=(move_only_sbo_storage<S, A, Allocator>&& s) {
     Base::operator=(std::move(s));
     return *this;
   }
@@ -457,5 +624,119 @@ public:
   /// deleted copy assignment
   move_only_sbo_storage& operator=(const move_only_sbo_storage& s) = delete;
 };
+
+/// Copyable storage with small buffer optimization, which keeps a pointer to
+/// its object in addition to the pointer to its resource table.
+///
+/// Unlike sbo_storage, data() is a single load and does not need to inspect
+/// the resource table to find out whether the object lives in the buffer or on
+/// the heap, which removes a dependent load from every method call of a
+/// Struct. In exchange, the storage is one pointer larger than sbo_storage.
+/// @tparam Size  size of the internal buffer in bytes
+/// @tparam Alignment alignment of internal buffer in bytes
+/// @tparam Allocator allocator for objects which do not fit into the buffer.
+/// Defaults to poly::allocator<std::byte>.
+template<std::size_t Size, std::size_t Alignment, typename Allocator>
+class cached_sbo_storage final
+    : public detail::
+          basic_sbo_storage<true, Size, Alignment, Allocator, true> {
+public:
+  template<std::size_t S, std::size_t A, typename Al>
+  friend class cached_sbo_storage;
+
+  using Base =
+      detail::basic_sbo_storage<true, Size, Alignment, Allocator, true>;
+  using Base::data;
+  using Base::emplace;
+
+  /// construct empty storage
+  constexpr cached_sbo_storage() noexcept : Base() {}
+
+  /// construct empty storage which allocates with alloc
+  explicit constexpr cached_sbo_storage(const Allocator& alloc) noexcept
+      : Base(alloc) {}
+
+  /// move ctor
+  template<std::size_t S, std::size_t A>
+  constexpr cached_sbo_storage(cached_sbo_storage<S, A, Allocator>&& s)
+      : Base(std::move(s)) {}
+  constexpr cached_sbo_storage(cached_sbo_storage&& s) : Base(std::move(s)) {}
+
+  /// copy ctor
+  constexpr cached_sbo_storage(const cached_sbo_storage& s) : Base(s) {}
+  template<std::size_t S, std::size_t A>
+  constexpr cached_sbo_storage(const cached_sbo_storage<S, A, Allocator>& s)
+      : Base(s) {}
+
+  /// move assignemnt
+  template<std::size_t S, std::size_t A>
+  constexpr cached_sbo_storage&
+  operator=(cached_sbo_storage<S, A, Allocator>&& s) {
+    Base::operator=(std::move(s));
+    return *this;
+  }
+
+  /// copy assignemnt
+  constexpr cached_sbo_storage& operator=(const cached_sbo_storage& s) {
+    Base::operator=(s);
+    return *this;
+  }
+  template<std::size_t S, std::size_t A>
+  constexpr cached_sbo_storage&
+  operator=(const cached_sbo_storage<S, A, Allocator>& s) {
+    Base::operator=(s);
+    return *this;
+  }
+};
+
+/// Move only version of cached_sbo_storage.
+/// @tparam Size  size of the internal buffer in bytes
+/// @tparam Alignment alignment of internal buffer in bytes
+/// @tparam Allocator allocator for objects which do not fit into the buffer.
+/// Defaults to poly::allocator<std::byte>.
+template<std::size_t Size, std::size_t Alignment, typename Allocator>
+class move_only_cached_sbo_storage final
+    : public detail::
+          basic_sbo_storage<false, Size, Alignment, Allocator, true> {
+public:
+  using Base =
+      detail::basic_sbo_storage<false, Size, Alignment, Allocator, true>;
+  using Base::data;
+  using Base::emplace;
+
+  /// construct empty storage
+  constexpr move_only_cached_sbo_storage() noexcept : Base() {}
+
+  /// construct empty storage which allocates with alloc
+  explicit constexpr move_only_cached_sbo_storage(
+      const Allocator& alloc) noexcept
+      : Base(alloc) {}
+
+  /// move ctor
+  template<std::size_t S, std::size_t A>
+  constexpr move_only_cached_sbo_storage(
+      move_only_cached_sbo_storage<S, A, Allocator>&& s)
+      : Base(std::move(s)) {}
+
+  /// deleted copy ctor
+  move_only_cached_sbo_storage(const move_only_cached_sbo_storage& s) = delete;
+
+  /// move assignment
+  template<std::size_t S, std::size_t A>
+  constexpr move_only_cached_sbo_storage&
+  operator=(move_only_cached_sbo_storage<S, A, Allocator>&& s) {
+    Base::operator=(std::move(s));
+    return *this;
+  }
+  constexpr move_only_cached_sbo_storage&
+  operator=(move_only_cached_sbo_storage&& s) {
+    Base::operator=(std::move(s));
+    return *this;
+  }
+
+  /// deleted copy assignment
+  move_only_cached_sbo_storage&
+  operator=(const move_only_cached_sbo_storage& s) = delete;
+};
 } // namespace poly
 #endif
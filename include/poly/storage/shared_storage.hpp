@@ -0,0 +1,193 @@
+/**
+ * Copyright 2024 Pelé Constam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POLY_STORAGE_SHARED_STORAGE_HPP
+#define POLY_STORAGE_SHARED_STORAGE_HPP
+#include "poly/alloc.hpp"
+#include "poly/config.hpp"
+#include "poly/fwd.hpp"
+#include "poly/traits.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+namespace poly {
+namespace detail {
+
+  /// reference count of a shared_block. The atomic count may be shared
+  /// between threads.
+  /// @{
+  template<bool Atomic>
+  class shared_count {
+  public:
+    void increment() noexcept { ++count_; }
+    /// returns true if the count dropped to zero
+    bool decrement() noexcept { return --count_ == 0; }
+    std::size_t get() const noexcept { return count_; }
+
+  private:
+    std::size_t count_{1};
+  };
+  template<>
+  class shared_count<true> {
+  public:
+    void increment() noexcept {
+      count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    /// returns true if the count dropped to zero
+    bool decrement() noexcept {
+      return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    /// acquire, so that a count of one also orders all accesses of previous
+    /// owners before the accesses of the last one.
+    std::size_t get() const noexcept {
+      return count_.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::atomic<std::size_t> count_{1};
+  };
+  /// @}
+
+  /// shared_storage contains a pointer to a shared_block. The reference count
+  /// and the object live in the same allocation.
+  template<bool Atomic>
+  struct shared_block {
+    shared_count<Atomic> count{};
+    void* obj{nullptr};
+    /// nullptr if the object is not copy constructible
+    shared_block* (*copy_)(const shared_block*){nullptr};
+    void (*destroy_)(shared_block*){nullptr};
+    /// returns a new block with a copy of the object and a count of one, or
+    /// nullptr if the allocation failed.
+    shared_block* copy() const { return this->copy_(this); }
+    void destroy() { this->destroy_(this); }
+  };
+
+  /// actual type allocated when using shared_storage.
+  /// templated only on size and alignment of a type, as the destructor is
+  /// stored in the shared_block.
+  template<bool Atomic, std::size_t Size, std::size_t Align>
+  struct shared_block_for : shared_block<Atomic> {
+    template<typename T, typename... Args>
+    shared_block_for(traits::Id<T>, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>)
+        : shared_block<Atomic>{{},
+                               nullptr,
+                               copy_function<T>(),
+                               +[](shared_block<Atomic>* b) {
+                                 std::destroy_at(static_cast<T*>(b->obj));
+                                 deallocate(static_cast<shared_block_for*>(b));
+                               }} {
+      this->obj = poly::detail::construct_at(reinterpret_cast<T*>(buffer),
+                                             std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    static constexpr auto copy_function() noexcept {
+      using copy_fn = shared_block<Atomic>* (*)(const shared_block<Atomic>*);
+      if constexpr (std::is_copy_constructible_v<T>) {
+        return copy_fn{+[](const shared_block<Atomic>* b) {
+          return static_cast<shared_block<Atomic>*>(
+              allocate<shared_block_for>(traits::Id<T>{},
+                                         *static_cast<const T*>(b->obj)));
+        }};
+      } else {
+        return copy_fn{nullptr};
+      }
+    }
+
+    alignas(Align) std::byte buffer[Size];
+  };
+
+  template<bool Atomic>
+  class basic_shared_storage {
+  public:
+    constexpr basic_shared_storage() noexcept = default;
+
+    basic_shared_storage(const basic_shared_storage& other) noexcept
+        : block_(other.block_) {
+      if (block_)
+        block_->count.increment();
+    }
+
+    basic_shared_storage(basic_shared_storage&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {}
+
+    ~basic_shared_storage() { reset(); }
+
+    basic_shared_storage&
+    operator=(const basic_shared_storage& other) noexcept {
+      if (block_ == other.block_)
+        return *this;
+      if (other.block_)
+        other.block_->count.increment();
+      reset();
+      block_ = other.block_;
+      return *this;
+    }
+
+    basic_shared_storage& operator=(basic_shared_storage&& other) noexcept {
+      if (this == &other)
+        return *this;
+      reset();
+      block_ = std::exchange(other.block_, nullptr);
+      return *this;
+    }
+
+    template<typename T, typename... Args>
+    T* emplace(Args&&... args) {
+      reset();
+      using block = shared_block_for<Atomic, sizeof(T), alignof(T)>;
+      block_ = allocate<block>(traits::Id<T>{}, std::forward<Args>(args)...);
+      return block_ ? static_cast<T*>(block_->obj) : nullptr;
+    }
+
+    void* data() noexcept { return block_ ? block_->obj : nullptr; }
+    const void* data() const noexcept { return block_ ? block_->obj : nullptr; }
+
+    /// returns the number of storages sharing the object, or 0 if the storage
+    /// is empty.
+    std::size_t use_count() const noexcept {
+      return block_ ? block_->count.get() : 0;
+    }
+
+  protected:
+    void reset() noexcept {
+      if (block_ == nullptr)
+        return;
+      if (block_->count.decrement())
+        block_->destroy(); // also deallocates block itself
+      block_ = nullptr;
+    }
+
+    shared_block<Atomic>* block_{nullptr};
+  };
+} // namespace detail
+
+/// Storage sharing ownership of a heap allocated object. Copying the storage
+/// increments a reference count stored in the same allocation as the object,
+/// the object is destroyed with the last storage referring to it. As the
+/// object is shared, modifications through one copy are visible in all
+/// copies, which makes it best suited for immutable objects. The reference
+/// count is not atomic, use atomic_shared_storage for objects shared between
+/// threads.
+using shared_storage = detail::basic_shared_storage<false>;
+
+/// shared_storage with an atomic reference count.
+using atomic_shared_storage = detail::basic_shared_storage<true>;
+} // namespace poly
+#endif
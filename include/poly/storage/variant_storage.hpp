@@ -21,7 +21,11 @@
 #include "poly/traits.hpp"
 #include "poly/type_list.hpp"
 
+#include <array>
+#include <cstring>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace poly {
 namespace detail {
@@ -41,18 +45,13 @@ namespace detail {
       static_assert(always_false<T>, "Library bug!");
     }
 
-    void copy(const variant_impl&, std::size_t) {}
-
-    void move(variant_impl&&, std::size_t) {}
-
-    constexpr void destroy(std::size_t) {}
     POLY_CONSTEXPR ~variant_impl() noexcept {}
   };
   template<std::size_t I, typename T1, typename... Ts>
   union variant_impl<I, T1, Ts...> {
     using value_type = T1;
     using types = type_list<T1, Ts...>;
-    static constexpr inline bool is_last = sizeof...(Ts) - 1 == I;
+    static constexpr inline bool is_last = sizeof...(Ts) == 0;
     using rest_type =
         std::conditional_t<is_last, NoValue, variant_impl<I + 1, Ts...>>;
 
@@ -85,38 +84,128 @@ namespace detail {
       }
     }
 
-    constexpr void copy(const variant_impl& other, std::size_t idx) {
-      if (I == idx) {
-        poly::detail::construct_at(&value_, other.value_);
-      } else {
-        if constexpr (not is_last)
-          rest_.copy(other.rest_, idx);
-      }
+    /// returns the member of the J-th type. Resolved at compile time.
+    /// @{
+    template<std::size_t J>
+    constexpr auto& get() noexcept {
+      if constexpr (J == I)
+        return value_;
+      else
+        return rest_.template get<J>();
+    }
+    template<std::size_t J>
+    constexpr const auto& get() const noexcept {
+      if constexpr (J == I)
+        return value_;
+      else
+        return rest_.template get<J>();
+    }
+    /// @}
+
+    POLY_CONSTEXPR ~variant_impl() noexcept {}
+  };
+
+  /// copy, relocation and destruction of the object in a variant_impl. For up
+  /// to switch_limit types, the operation for the type with index idx is
+  /// selected by a chain of comparisons, which compilers turn into a switch
+  /// and inline. For more types it is looked up in a table of function
+  /// pointers, so the cost does not depend on the number of types.
+  /// @{
+  template<typename Indices, typename... Ts>
+  struct variant_operations;
+  template<std::size_t... Is, typename... Ts>
+  struct variant_operations<std::index_sequence<Is...>, Ts...> {
+    using impl_type = variant_impl<0, Ts...>;
+    static constexpr std::size_t npos = sizeof...(Ts);
+    static constexpr std::size_t switch_limit = 16;
+
+    template<std::size_t I>
+    static constexpr void copy_one(impl_type& dest, const impl_type& src) {
+      poly::detail::construct_at(&dest.template get<I>(),
+                                 src.template get<I>());
     }
 
-    constexpr void move(variant_impl&& other, std::size_t idx) {
-      if (I == idx) {
-        poly::detail::construct_at(&value_, std::move(other.value_));
+    /// moves the object of src into dest and destroys it in src. Objects of
+    /// types marked with is_trivially_relocatable are copied bytewise
+    /// instead. Trivially copyable types take the regular path, which
+    /// compiles down to the same copy, but stays usable in constant
+    /// expressions.
+    template<std::size_t I>
+    static constexpr void relocate_one(impl_type& dest, impl_type& src) {
+      auto& value = src.template get<I>();
+      using T = std::remove_reference_t<decltype(value)>;
+      if constexpr (is_trivially_relocatable_v<T> and
+                    not std::is_trivially_copyable_v<T>) {
+        std::memcpy(static_cast<void*>(&dest.template get<I>()),
+                    static_cast<const void*>(&value), sizeof(T));
       } else {
-        if constexpr (not is_last)
-          rest_.move(std::move(other.rest_), idx);
+        poly::detail::construct_at(&dest.template get<I>(), std::move(value));
+        std::destroy_at(&value);
       }
     }
 
-    constexpr void destroy(std::size_t idx) {
-      if (I == idx) {
-        std::destroy_at(&value_);
-      } else {
-        if constexpr (not is_last)
-          rest_.destroy(idx);
+    template<std::size_t I>
+    static constexpr void destroy_one(impl_type& impl) {
+      std::destroy_at(&impl.template get<I>());
+    }
+
+    static constexpr std::array<void (*)(impl_type&, const impl_type&), npos>
+        copy_table{&copy_one<Is>...};
+    static constexpr std::array<void (*)(impl_type&, impl_type&), npos>
+        relocate_table{&relocate_one<Is>...};
+    static constexpr std::array<void (*)(impl_type&), npos> destroy_table{
+        &destroy_one<Is>...};
+
+    /// true if all types are trivially copyable and the union fits into a
+    /// cache line. The whole union is copied then, which needs no branch on
+    /// the index.
+    static constexpr bool trivial =
+        (std::is_trivially_copyable_v<Ts> and ...) and
+        sizeof(impl_type) <= config::cache_line_size;
+
+    /// copies the object with index idx from src into the empty dest
+    static constexpr void copy(impl_type& dest, const impl_type& src,
+                               std::size_t idx) {
+      if (trivial and not std::is_constant_evaluated())
+        std::memcpy(static_cast<void*>(&dest), static_cast<const void*>(&src),
+                    sizeof(impl_type));
+      else if constexpr (npos <= switch_limit)
+        (void)((idx == Is and (copy_one<Is>(dest, src), true)) or ...);
+      else if (idx != npos)
+        copy_table[idx](dest, src);
+    }
+
+    /// moves the object with index idx from src into the empty dest, and
+    /// leaves src empty.
+    static constexpr void relocate(impl_type& dest, impl_type& src,
+                                   std::size_t idx) {
+      if (trivial and not std::is_constant_evaluated())
+        std::memcpy(static_cast<void*>(&dest), static_cast<const void*>(&src),
+                    sizeof(impl_type));
+      else if constexpr (npos <= switch_limit)
+        (void)((idx == Is and (relocate_one<Is>(dest, src), true)) or ...);
+      else if (idx != npos)
+        relocate_table[idx](dest, src);
+    }
+
+    static constexpr void destroy(impl_type& impl, std::size_t idx) {
+      if constexpr (not(std::is_trivially_destructible_v<Ts> and ...)) {
+        if constexpr (npos <= switch_limit)
+          (void)((idx == Is and (destroy_one<Is>(impl), true)) or ...);
+        else if (idx != npos)
+          destroy_table[idx](impl);
       }
     }
-    POLY_CONSTEXPR ~variant_impl() noexcept {}
   };
+  template<typename... Ts>
+  using variant_operations_for =
+      variant_operations<std::index_sequence_for<Ts...>, Ts...>;
+  /// @}
 
   template<bool Copyable, typename... Ts>
   class variant_storage_impl {
     using index_type = traits::smallest_uint_to_contain<sizeof...(Ts)>;
+    using operations = variant_operations_for<Ts...>;
     variant_impl<0, Ts...> impl_;
     index_type idx;
 
@@ -146,31 +235,27 @@ namespace detail {
     constexpr variant_storage_impl(const variant_storage_impl& other) noexcept(
         nothrow_copyable)
         : variant_storage_impl() {
-      impl_.copy(other.impl_, other.idx);
+      operations::copy(impl_, other.impl_, other.idx);
       idx = other.idx;
     }
 
     constexpr variant_storage_impl(variant_storage_impl&& other) noexcept(
         nothrow_movable)
         : variant_storage_impl() {
-      impl_.move(std::move(other.impl_), other.idx);
-      other.impl_.destroy(other.idx);
+      operations::relocate(impl_, other.impl_, other.idx);
       idx = std::exchange(other.idx, sizeof...(Ts));
     }
 
-    POLY_CONSTEXPR ~variant_storage_impl() {
-      if (idx != sizeof...(Ts))
-        impl_.destroy(idx);
-    }
+    POLY_CONSTEXPR ~variant_storage_impl() { operations::destroy(impl_, idx); }
 
     constexpr variant_storage_impl&
     operator=(variant_storage_impl&& other) noexcept(nothrow_movable and
                                                      nothrow_destructible) {
       if (this == &other)
         return *this;
-      impl_.destroy(idx);
-      impl_.move(std::move(other.impl_), other.idx);
-      other.impl_.destroy(other.idx);
+      operations::destroy(impl_, idx);
+      idx = sizeof...(Ts);
+      operations::relocate(impl_, other.impl_, other.idx);
       idx = std::exchange(other.idx, sizeof...(Ts));
       return *this;
     }
@@ -180,8 +265,9 @@ namespace detail {
                                                     nothrow_destructible) {
       if (this == &other)
         return *this;
-      impl_.destroy(idx);
-      impl_.copy(other.impl_, other.idx);
+      operations::destroy(impl_, idx);
+      idx = sizeof...(Ts);
+      operations::copy(impl_, other.impl_, other.idx);
       idx = other.idx;
       return *this;
     }
@@ -190,8 +276,8 @@ namespace detail {
     constexpr T*
     emplace(Args&&... args) noexcept(std::is_constructible_v<T, Args&&...>) {
       static_assert(contains_v<types, T>, "T ist not a valid variant option");
-      impl_.destroy(idx);
-      idx = 0;
+      operations::destroy(impl_, idx);
+      idx = sizeof...(Ts);
       T* t = impl_.template create<T>(std::forward<Args>(args)...);
       idx = index_of_v<types, T>;
       return t;
@@ -204,10 +290,15 @@ namespace detail {
     constexpr const void* data() const noexcept {
       return idx != sizeof...(Ts) ? static_cast<const void*>(&impl_) : nullptr;
     }
+
+    /// returns the index of the type of the contained object in Ts, or
+    /// sizeof...(Ts) if the storage is empty.
+    constexpr std::size_t index() const noexcept { return idx; }
   };
   template<typename... Ts>
   class variant_storage_impl<false, Ts...> {
     using index_type = traits::smallest_uint_to_contain<sizeof...(Ts)>;
+    using operations = variant_operations_for<Ts...>;
     variant_impl<0, Ts...> impl_;
     index_type idx;
 
@@ -231,24 +322,20 @@ namespace detail {
     constexpr variant_storage_impl(variant_storage_impl&& other) noexcept(
         nothrow_movable)
         : variant_storage_impl() {
-      impl_.move(std::move(other.impl_), other.idx);
-      other.impl_.destroy(other.idx);
+      operations::relocate(impl_, other.impl_, other.idx);
       idx = std::exchange(other.idx, sizeof...(Ts));
     }
 
-    POLY_CONSTEXPR ~variant_storage_impl() {
-      if (idx != sizeof...(Ts))
-        impl_.destroy(idx);
-    }
+    POLY_CONSTEXPR ~variant_storage_impl() { operations::destroy(impl_, idx); }
 
     constexpr variant_storage_impl&
     operator=(variant_storage_impl&& other) noexcept(nothrow_movable and
                                                      nothrow_destructible) {
       if (this == &other)
         return *this;
-      impl_.destroy(idx);
-      impl_.move(std::move(other.impl_), other.idx);
-      other.impl_.destroy(other.idx);
+      operations::destroy(impl_, idx);
+      idx = sizeof...(Ts);
+      operations::relocate(impl_, other.impl_, other.idx);
       idx = std::exchange(other.idx, sizeof...(Ts));
       return *this;
     }
@@ -260,8 +347,8 @@ namespace detail {
     constexpr T*
     emplace(Args&&... args) noexcept(std::is_constructible_v<T, Args&&...>) {
       static_assert(contains_v<types, T>, "T ist not a valid variant option");
-      impl_.destroy(idx);
-      idx = 0;
+      operations::destroy(impl_, idx);
+      idx = sizeof...(Ts);
       T* t = impl_.template create<T>(std::forward<Args>(args)...);
       idx = index_of_v<types, T>;
       return t;
@@ -274,6 +361,10 @@ namespace detail {
     constexpr const void* data() const noexcept {
       return idx != sizeof...(Ts) ? static_cast<const void*>(&impl_) : nullptr;
     }
+
+    /// returns the index of the type of the contained object in Ts, or
+    /// sizeof...(Ts) if the storage is empty.
+    constexpr std::size_t index() const noexcept { return idx; }
   };
 } // namespace detail
 /// The variant storage can store an object of type T, if T is in the pack Ts.
@@ -296,6 +387,7 @@ public:
                                    Ts...>;
   using Base::Base;
   using Base::data;
+  using Base::index;
 
   constexpr variant_storage() noexcept = default;
   variant_storage(const variant_storage& other) noexcept(
@@ -18,7 +18,10 @@
 #include "poly/method_table.hpp"
 #include "poly/property_table.hpp"
 #include "poly/storage.hpp"
+#include "poly/vtable_policy.hpp"
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace poly {
 namespace detail {
@@ -26,25 +29,74 @@ namespace detail {
   inline constexpr bool nothrow_emplaceable_v = noexcept(
       std::declval<Storage>().template emplace<T>(std::declval<Args>()...));
 
+  /// provides a unique address for each type T
+  template<typename T>
+  struct type_tag {
+    static constexpr char id{0};
+  };
+
+  /// identifies the type T a struct_table was created for. It is always
+  /// the first base of a struct_table, so that Interfaces can access it
+  /// without knowing the type of the struct_table.
+  struct type_entry {
+    template<typename T>
+    constexpr type_entry(poly::traits::Id<T>) noexcept
+        : type_id(&type_tag<T>::id) {}
+    constexpr type_entry() noexcept = default;
+
+    template<typename T>
+    constexpr bool holds() const noexcept {
+      return type_id == &type_tag<T>::id;
+    }
+
+    const void* type_id{nullptr};
+  };
+
   template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
   struct struct_table;
   template<template<typename...> typename L, POLY_PROP_SPEC... PropertySpecs,
            POLY_METHOD_SPEC... MethodSpecs>
   struct struct_table<L<PropertySpecs...>, L<MethodSpecs...>>
-      : method_table<MethodSpecs...>, property_table<PropertySpecs...> {
+      : type_entry,
+        method_table<MethodSpecs...>,
+        property_table<PropertySpecs...> {
     using vtable_type = method_table<MethodSpecs...>;
     using ptable_type = property_table<PropertySpecs...>;
+    using btable_type = batch_table<MethodSpecs...>;
 
     template<typename T>
     constexpr struct_table(poly::traits::Id<T> id) noexcept
-        : method_table<MethodSpecs...>(id),
-          property_table<PropertySpecs...>(id) {}
+        : type_entry(id), method_table<MethodSpecs...>(id),
+          property_table<PropertySpecs...>(id),
+          batch(&batch_table_for<T, L<MethodSpecs...>>) {}
+
+    /// creates a table containing a subset of the entries of other. btable
+    /// must point to a batch table with the entries of other.batch.
+    template<template<typename...> typename L2, typename... Ps, typename... Ms>
+    constexpr struct_table(const struct_table<L2<Ps...>, L2<Ms...>>& other,
+                           const btable_type* btable) noexcept
+        : type_entry(other),
+          method_table<MethodSpecs...>(
+              static_cast<const method_table<Ms...>&>(other)),
+          property_table<PropertySpecs...>(
+              static_cast<const property_table<Ps...>&>(other)),
+          batch(btable) {}
     constexpr struct_table() = default;
 
+    /// batch entries for the type this table was created for
+    const btable_type* batch{nullptr};
+
     template<typename T>
     static method_offset_type method_offset(traits::Id<T>) noexcept {
-      // no offset for first base -> return VTable::method_offset() directly
-      return method_table<MethodSpecs...>::method_offset(traits::Id<T>{});
+      constexpr struct_table<L<PropertySpecs...>, L<MethodSpecs...>> t;
+      const std::byte* this_ =
+          static_cast<const std::byte*>(static_cast<const void*>(&t));
+      const std::byte* vtable =
+          static_cast<const std::byte*>(static_cast<const void*>(
+              static_cast<const method_table<MethodSpecs...>*>(&t)));
+      const size_t table_offset = vtable - this_;
+      return table_offset +
+             method_table<MethodSpecs...>::method_offset(traits::Id<T>{});
     }
     template<typename T>
     static property_offset_type property_offset(traits::Id<T>) noexcept {
@@ -60,35 +112,100 @@ namespace detail {
     }
   };
 
+#if POLY_USE_COMPACT_VTABLE
+  /// Compact tables are not constant expressions, so they are initialized
+  /// dynamically before main() is entered. Structs must therefore not be bound
+  /// to objects during the dynamic initialization of other static variables.
+  template<typename T, POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  inline const struct_table<PropertySpecs, MethodSpecs> struct_table_for =
+      struct_table<PropertySpecs, MethodSpecs>(poly::traits::Id<T>{});
+#else
   template<typename T, POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
   inline constexpr struct_table struct_table_for =
       struct_table<PropertySpecs, MethodSpecs>(poly::traits::Id<T>{});
+#endif
+
+  /// returns the struct_table for T
+  template<typename T, POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
+  constexpr const struct_table<PropertySpecs, MethodSpecs>*
+  table_for() noexcept {
+    return &struct_table_for<T, PropertySpecs, MethodSpecs>;
+  }
 
   template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
-           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST OverLoads>
+           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST OverLoads,
+           typename VTablePolicy = offset_vtable>
   struct POLY_EMPTY_BASE interface_impl;
 
+  /// holds the table of a Struct. What is stored in the Struct depends on
+  /// the vtable policy.
+  /// @{
+  template<typename Table, typename VTablePolicy>
+  struct struct_vtable;
+
+  template<typename Table>
+  struct struct_vtable<Table, pointer_vtable> {
+    using vtable_type = typename Table::vtable_type;
+
+    constexpr struct_vtable() noexcept = default;
+    constexpr struct_vtable(const Table* table) noexcept : table_(table) {}
+
+    constexpr const Table* table() const noexcept { return table_; }
+    constexpr const vtable_type* methods() const noexcept { return table_; }
+
+  private:
+    const Table* table_{nullptr};
+  };
+
+  template<typename Table>
+  struct struct_vtable<Table, inline_vtable> {
+    using vtable_type = typename Table::vtable_type;
+
+    constexpr struct_vtable() noexcept = default;
+    constexpr struct_vtable(const Table* table) noexcept
+        : table_(table),
+          methods_(table ? static_cast<const vtable_type&>(*table)
+                         : vtable_type{}) {}
+
+    constexpr const Table* table() const noexcept { return table_; }
+    constexpr const vtable_type* methods() const noexcept {
+      return table_ ? &methods_ : nullptr;
+    }
+
+  private:
+    const Table* table_{nullptr};
+    vtable_type methods_{};
+  };
+  /// @}
+
   template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
-           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST Overloads>
+           POLY_TYPE_LIST MethodSpecs, POLY_TYPE_LIST Overloads,
+           typename VTablePolicy = pointer_vtable>
   struct POLY_EMPTY_BASE struct_impl;
 
+  struct dispatch_access;
+
   template<POLY_STORAGE StorageType, template<typename...> typename L,
            POLY_PROP_SPEC... PropertySpecs, POLY_TYPE_LIST MethodSpecs,
-           typename... OverLoads>
+           typename... OverLoads, typename VTablePolicy>
   struct POLY_EMPTY_BASE struct_impl<StorageType, L<PropertySpecs...>,
-                                     MethodSpecs, L<OverLoads...>>
+                                     MethodSpecs, L<OverLoads...>,
+                                     VTablePolicy>
       : public detail::method_injector_for_t<
             struct_impl<StorageType, L<PropertySpecs...>, MethodSpecs,
-                        L<OverLoads...>>,
+                        L<OverLoads...>, VTablePolicy>,
             OverLoads>...,
         detail::property_injector_for_t<
             struct_impl<StorageType, L<PropertySpecs...>, MethodSpecs,
-                        L<OverLoads...>>,
+                        L<OverLoads...>, VTablePolicy>,
             PropertySpecs>... {
-    template<POLY_STORAGE, POLY_TYPE_LIST, POLY_TYPE_LIST, POLY_TYPE_LIST>
+    template<POLY_STORAGE, POLY_TYPE_LIST, POLY_TYPE_LIST, POLY_TYPE_LIST,
+             typename>
     friend struct POLY_EMPTY_BASE struct_impl;
-    template<POLY_STORAGE, POLY_TYPE_LIST, POLY_TYPE_LIST, POLY_TYPE_LIST>
+    template<POLY_STORAGE, POLY_TYPE_LIST, POLY_TYPE_LIST, POLY_TYPE_LIST,
+             typename>
     friend struct poly::detail::interface_impl;
+    friend struct poly::detail::dispatch_access;
 
   public:
     using method_specs = MethodSpecs;
@@ -146,47 +263,47 @@ namespace detail {
     /// @{
     constexpr struct_impl(const struct_impl& other) noexcept(
         std::is_nothrow_copy_constructible_v<StorageType>)
-        : storage_(other.storage_), vtbl_(other.vtbl_) {}
+        : vtbl_(other.vtbl_), storage_(other.storage_) {}
 
-    template<typename OtherStorage,
+    template<typename OtherStorage, typename OtherPolicy,
              typename = std::enable_if_t<
                  std::is_constructible_v<StorageType, const OtherStorage&>>>
     constexpr struct_impl(
         const struct_impl<OtherStorage, property_specs, method_specs,
-                          L<OverLoads...>>&
+                          L<OverLoads...>, OtherPolicy>&
             other) noexcept(std::
                                 is_nothrow_constructible_v<StorageType,
                                                            const OtherStorage&>)
-        : storage_(other.storage_), vtbl_(other.vtbl_) {}
+        : vtbl_(other.vtbl_.table()), storage_(other.storage_) {}
     /// @}
 
     /// ctor for lvalue reference (Storage = ref storage, OtherStorage= any
     /// storage type)
-    template<typename OtherStorage,
+    template<typename OtherStorage, typename OtherPolicy,
              typename = std::enable_if_t<
                  std::is_constructible_v<StorageType, OtherStorage&>>>
     constexpr struct_impl(
         struct_impl<OtherStorage, property_specs, method_specs,
-                    L<OverLoads...>>& other) noexcept
-        : storage_(other.storage_), vtbl_(other.vtbl_) {}
+                    L<OverLoads...>, OtherPolicy>& other) noexcept
+        : vtbl_(other.vtbl_.table()), storage_(other.storage_) {}
 
     /// move ctor
     /// @{
-    template<typename OtherStorage,
+    template<typename OtherStorage, typename OtherPolicy,
              typename = std::enable_if_t<
                  std::is_constructible_v<StorageType, OtherStorage&&>>>
     constexpr struct_impl(
         struct_impl<OtherStorage, property_specs, method_specs,
-                    L<OverLoads...>>&&
+                    L<OverLoads...>, OtherPolicy>&&
             other) noexcept(std::is_nothrow_constructible_v<StorageType,
                                                             OtherStorage&&>)
-        : storage_(std::move(other.storage_)),
-          vtbl_(std::exchange(other.vtbl_, nullptr)) {}
+        : vtbl_(std::exchange(other.vtbl_, nullptr).table()),
+          storage_(std::move(other.storage_)) {}
 
     constexpr struct_impl(struct_impl&& other) noexcept(
         std::is_nothrow_constructible_v<StorageType, StorageType&&>)
-        : storage_(std::move(other.storage_)),
-          vtbl_(std::exchange(other.vtbl_, nullptr)) {}
+        : vtbl_(std::exchange(other.vtbl_, nullptr)),
+          storage_(std::move(other.storage_)) {}
     /// @}
 
     /// construct from a T
@@ -197,9 +314,9 @@ namespace detail {
         detail::nothrow_emplaceable_v<StorageType, std::decay_t<T>,
                                       decltype(t)>) {
       storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
-      vtbl_ = &detail::struct_table_for<std::decay_t<T>,
+      vtbl_ = detail::table_for<std::decay_t<T>,
                                         property_specs,
-                                        method_specs>;
+                                        method_specs>();
     }
 
     /// in place constructing a T
@@ -207,9 +324,36 @@ namespace detail {
     constexpr struct_impl(traits::Id<T>, Args&&... args) noexcept(
         detail::nothrow_emplaceable_v<StorageType, T, decltype(args)...>) {
       storage_.template emplace<T>(std::forward<Args>(args)...);
-      vtbl_ = &detail::struct_table_for<std::decay_t<T>,
+      vtbl_ = detail::table_for<std::decay_t<T>,
                                         property_specs,
-                                        method_specs>;
+                                        method_specs>();
+    }
+    /// @}
+
+    /// construct from a T, with the storage constructed from alloc. Enabled
+    /// if StorageType is constructible from alloc, i.e. for the sbo and heap
+    /// storages.
+    /// @{
+    template<typename Alloc, typename T,
+             typename = std::enable_if_t<
+                 std::is_constructible_v<StorageType, const Alloc&> and
+                 not std::is_base_of_v<struct_impl, std::decay_t<T>>>>
+    constexpr struct_impl(std::allocator_arg_t, const Alloc& alloc, T&& t)
+        : storage_(alloc) {
+      storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
+      vtbl_ = detail::table_for<std::decay_t<T>, property_specs,
+                                method_specs>();
+    }
+
+    /// in place constructing a T
+    template<typename Alloc, typename T, typename... Args,
+             typename = std::enable_if_t<
+                 std::is_constructible_v<StorageType, const Alloc&>>>
+    constexpr struct_impl(std::allocator_arg_t, const Alloc& alloc,
+                          traits::Id<T>, Args&&... args)
+        : storage_(alloc) {
+      storage_.template emplace<T>(std::forward<Args>(args)...);
+      vtbl_ = detail::table_for<T, property_specs, method_specs>();
     }
     /// @}
 
@@ -220,31 +364,31 @@ namespace detail {
       vtbl_ = other.vtbl_;
       return *this;
     }
-    template<typename OtherStorage,
+    template<typename OtherStorage, typename OtherPolicy,
              typename = std::enable_if_t<
                  std::is_assignable_v<StorageType, const OtherStorage&>>>
     constexpr struct_impl& operator=(
         const struct_impl<OtherStorage, property_specs, method_specs,
-                          L<OverLoads...>>&
+                          L<OverLoads...>, OtherPolicy>&
             other) noexcept(std::is_nothrow_assignable_v<StorageType,
                                                          const OtherStorage&>) {
       vtbl_ = nullptr;
       storage_ = other.storage_;
-      vtbl_ = other.vtbl_;
+      vtbl_ = other.vtbl_.table();
       return *this;
     }
 
-    template<typename OtherStorage,
+    template<typename OtherStorage, typename OtherPolicy,
              typename = std::enable_if_t<
                  std::is_assignable_v<StorageType, OtherStorage&&>>>
     constexpr struct_impl& operator=(
         struct_impl<OtherStorage, property_specs, method_specs,
-                    L<OverLoads...>>&&
+                    L<OverLoads...>, OtherPolicy>&&
             other) noexcept(std::is_nothrow_assignable_v<StorageType,
                                                          OtherStorage&&>) {
       vtbl_ = nullptr;
       storage_ = std::move(other.storage_);
-      vtbl_ = std::exchange(other.vtbl_, nullptr);
+      vtbl_ = std::exchange(other.vtbl_, nullptr).table();
       return *this;
     }
     constexpr struct_impl& operator=(struct_impl&& other) noexcept(
@@ -263,9 +407,9 @@ namespace detail {
                               decltype(std::forward<T>(std::declval<T&&>()))>) {
       vtbl_ = nullptr;
       storage_.template emplace<std::decay_t<T>>(std::forward<T>(t));
-      vtbl_ = &detail::struct_table_for<std::decay_t<T>,
+      vtbl_ = detail::table_for<std::decay_t<T>,
                                         property_specs,
-                                        method_specs>;
+                                        method_specs>();
       return *this;
     }
 
@@ -283,9 +427,14 @@ namespace detail {
           std::is_invocable_v<const vtable_type, MethodName, void*, Args...>,
           "Attempting to call a method that does not exist!");
       assert(vtable());
-      return (*vtable())(MethodName{},
-                         storage_.data(),
-                         std::forward<Args>(args)...);
+      if constexpr (is_mutating_call_v<vtable_type, MethodName, Args&&...>)
+        return (*vtable())(MethodName{},
+                           storage_.data(),
+                           std::forward<Args>(args)...);
+      else
+        return (*vtable())(MethodName{},
+                           std::as_const(storage_).data(),
+                           std::forward<Args>(args)...);
     }
 
     /**
@@ -332,6 +481,61 @@ namespace detail {
       return ptable()->get(Name{}, storage_.data());
     }
 
+    /**
+     * Call a non const method. If the bound object is one of Ts, the
+     * extension function of that type is called directly instead of through
+     * the method table. The types are checked in the order given.
+     * @param args parameters for the method
+     * @tparam MethodName name of the method
+     * @tparam Ts likely types of the bound object
+     * @returns the value returned by the method
+     */
+    template<typename MethodName, typename... Ts, typename... Args>
+    constexpr decltype(auto)
+    call_as(Args&&... args) noexcept(nothrow_callable<MethodName, Args...>) {
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+
+    /**
+     * Call a const method. If the bound object is one of Ts, the
+     * extension function of that type is called directly instead of through
+     * the method table. The types are checked in the order given.
+     * @param args parameters for the method
+     * @tparam MethodName name of the method
+     * @tparam Ts likely types of the bound object
+     * @returns the value returned by the method
+     */
+    template<typename MethodName, typename... Ts, typename... Args>
+    constexpr decltype(auto) call_as(Args&&... args) const
+        noexcept(nothrow_callable<MethodName, Args...>) {
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+
+    /**
+     * returns true if the bound object is of type T, else false.
+     */
+    template<typename T>
+    constexpr bool holds() const noexcept {
+      return vtbl_.table() ==
+             detail::table_for<T, property_specs, method_specs>();
+    }
+
+    /**
+     * returns a pointer to the bound object if it is of type T, else nullptr.
+     */
+    /// @{
+    template<typename T>
+    constexpr T* target() noexcept {
+      return holds<T>() ? static_cast<T*>(storage_.data()) : nullptr;
+    }
+    template<typename T>
+    constexpr const T* target() const noexcept {
+      return holds<T>() ? static_cast<const T*>(storage_.data()) : nullptr;
+    }
+    /// @}
+
     /**
      * returns true if an object is bound to the struct, i.e. the storage is not
      * empty, else false.
@@ -346,11 +550,56 @@ namespace detail {
     constexpr operator bool() const { return is_bound(); }
 
   private:
-    constexpr const vtable_type* vtable() const noexcept { return vtbl_; }
-    constexpr const ptable_type* ptable() const noexcept { return vtbl_; }
-
     using struct_table = detail::struct_table<property_specs, method_specs>;
-    const struct_table* vtbl_{nullptr};
+
+    template<typename MethodName, typename T, typename... Ts, typename... Args>
+    constexpr decltype(auto) call_as_impl(type_list<T, Ts...>,
+                                          Args&&... args) {
+      if constexpr (not is_mutating_call_v<vtable_type, MethodName,
+                                           Args&&...>) {
+        return std::as_const(*this).template call_as_impl<MethodName>(
+            type_list<T, Ts...>{}, std::forward<Args>(args)...);
+      } else {
+        if (holds<T>())
+          return vtable_type::invoke_as(traits::Id<T>{},
+                                        MethodName{},
+                                        storage_.data(),
+                                        std::forward<Args>(args)...);
+        return call_as_impl<MethodName>(type_list<Ts...>{},
+                                        std::forward<Args>(args)...);
+      }
+    }
+    template<typename MethodName, typename T, typename... Ts, typename... Args>
+    constexpr decltype(auto) call_as_impl(type_list<T, Ts...>,
+                                          Args&&... args) const {
+      if (holds<T>())
+        return vtable_type::invoke_as(traits::Id<T>{},
+                                      MethodName{},
+                                      storage_.data(),
+                                      std::forward<Args>(args)...);
+      return call_as_impl<MethodName>(type_list<Ts...>{},
+                                      std::forward<Args>(args)...);
+    }
+    template<typename MethodName, typename... Args>
+    constexpr decltype(auto) call_as_impl(type_list<>, Args&&... args) {
+      return call<MethodName>(std::forward<Args>(args)...);
+    }
+    template<typename MethodName, typename... Args>
+    constexpr decltype(auto) call_as_impl(type_list<>, Args&&... args) const {
+      return call<MethodName>(std::forward<Args>(args)...);
+    }
+
+    constexpr const vtable_type* vtable() const noexcept {
+      return vtbl_.methods();
+    }
+    constexpr const ptable_type* ptable() const noexcept {
+      return vtbl_.table();
+    }
+    constexpr const struct_table* table() const noexcept {
+      return vtbl_.table();
+    }
+
+    detail::struct_vtable<struct_table, VTablePolicy> vtbl_{};
     StorageType storage_{};
   };
 } // namespace detail
@@ -391,13 +640,19 @@ namespace detail {
 /// @tparam StorageType storage used for objects emplaced. Must conform to the
 /// poly::Storage concept.
 /// @tparam PropertySpecs a TypeList of @ref PropertySpec "PropertySpecs"
-/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs"
+/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs", which may
+/// be marked poly::hot or poly::cold
+/// @tparam VTablePolicy poly::pointer_vtable(default), poly::inline_vtable or
+/// poly::auto_vtable. See @ref vtable_policy "VTable Policies".
 /// @{
 template<POLY_STORAGE StorageType, POLY_TYPE_LIST PropertySpecs,
-         POLY_TYPE_LIST MethodSpecs>
-using Struct =
-    detail::struct_impl<StorageType, PropertySpecs, MethodSpecs,
-                        typename detail::collapse_overloads<MethodSpecs>::type>;
+         POLY_TYPE_LIST MethodSpecs, typename VTablePolicy = pointer_vtable>
+using Struct = detail::struct_impl<
+    StorageType, PropertySpecs, detail::arrange_methods_t<MethodSpecs>,
+    typename detail::collapse_overloads<
+        detail::arrange_methods_t<MethodSpecs>>::type,
+    detail::resolve_vtable_policy_t<VTablePolicy,
+                                    detail::list_size<MethodSpecs>::value>>;
 
 /// A Reference is a non owning Struct and cheap to copy.
 ///
@@ -412,9 +667,13 @@ using Struct =
 /// properties of the Reference are accessed.
 ///
 /// @tparam PropertySpecs a TypeList of @ref PropertySpec "PropertySpecs"
-/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs"
-template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs>
-using Reference = Struct<ref_storage, PropertySpecs, MethodSpecs>;
+/// @tparam MethodSpecs a TypeList of @ref MethodSpec "MethodSpecs", which may
+/// be marked poly::hot or poly::cold
+/// @tparam VTablePolicy poly::pointer_vtable(default), poly::inline_vtable or
+/// poly::auto_vtable. See @ref vtable_policy "VTable Policies".
+template<POLY_TYPE_LIST PropertySpecs, POLY_TYPE_LIST MethodSpecs,
+         typename VTablePolicy = pointer_vtable>
+using Reference = Struct<ref_storage, PropertySpecs, MethodSpecs, VTablePolicy>;
 
 /// @}
 
@@ -0,0 +1,86 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_TABLE_FUNCTION_HPP
+#define POLY_TABLE_FUNCTION_HPP
+#include "poly/config.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <exception>
+
+namespace poly::detail {
+/// A function pointer stored in a method or property table.
+///
+/// By default, it is a plain function pointer. If POLY_COMPACT_VTABLE is
+/// defined, it is stored as a 32 bit offset relative to
+/// compact_vtable_base(), which halves the size of the tables on 64 bit
+/// platforms. The offset is computed at run time, so tables are initialized
+/// dynamically before main() instead of being constant expressions.
+///
+/// @tparam F function type
+/// @{
+#if POLY_USE_COMPACT_VTABLE
+/// the function the offsets in compact tables are relative to
+inline void compact_vtable_base() noexcept {}
+
+template<typename F>
+class table_function {
+public:
+  constexpr table_function() noexcept = default;
+  table_function(F* f) noexcept : offset_(encode(f)) {}
+
+  F* get() const noexcept {
+    assert(offset_ != 0);
+    return reinterpret_cast<F*>(base() + offset_);
+  }
+
+  explicit operator bool() const noexcept { return offset_ != 0; }
+
+private:
+  static std::intptr_t base() noexcept {
+    return reinterpret_cast<std::intptr_t>(&compact_vtable_base);
+  }
+
+  static std::int32_t encode(F* f) noexcept {
+    assert(f);
+    const std::intptr_t offset = reinterpret_cast<std::intptr_t>(f) - base();
+    // fails if the function lives too far from compact_vtable_base(), i.e.
+    // in another shared library. Compact tables cannot be used then.
+    if (offset < INT32_MIN or offset > INT32_MAX or offset == 0)
+      std::terminate();
+    return static_cast<std::int32_t>(offset);
+  }
+
+  std::int32_t offset_{0};
+};
+#else
+template<typename F>
+class table_function {
+public:
+  constexpr table_function() noexcept = default;
+  constexpr table_function(F* f) noexcept : f_(f) {}
+
+  constexpr F* get() const noexcept { return f_; }
+
+  constexpr explicit operator bool() const noexcept { return f_ != nullptr; }
+
+private:
+  F* f_{nullptr};
+};
+#endif
+/// @}
+} // namespace poly::detail
+#endif
@@ -0,0 +1,159 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_TASK_QUEUE_HPP
+#define POLY_TASK_QUEUE_HPP
+#include "poly/config.hpp"
+#include "poly/function.hpp"
+#include "poly/storage/local_storage.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace poly {
+
+/// Bounded lock free queue of tasks for many producers and one consumer.
+///
+/// The queue is a ring buffer of Capacity slots. Each slot holds a
+/// once_function<void(), move_only_local_storage<TaskSize, Alignment>>, so
+/// pushing a task never allocates, and tasks are constructed directly in
+/// their slot. The consumer runs tasks where they are stored.
+///
+/// Every slot has a sequence number, which tells producers and the consumer
+/// whether the slot is free or holds a task of the current round. Producers
+/// claim a slot by advancing the shared enqueue position with a compare and
+/// swap, construct the task and publish the slot by advancing its sequence
+/// number.
+///
+/// @tparam Capacity number of slots, must be a power of two
+/// @tparam TaskSize size of the buffer of each task in bytes
+/// @tparam Alignment alignment of the buffer of each task in bytes
+template<std::size_t Capacity, std::size_t TaskSize,
+         std::size_t Alignment = alignof(std::max_align_t)>
+class task_queue {
+  static_assert(Capacity >= 2 and (Capacity & (Capacity - 1)) == 0,
+                "The Capacity of a task_queue must be a power of two.");
+
+public:
+  using task_type =
+      once_function<void(), move_only_local_storage<TaskSize, Alignment>>;
+
+  task_queue() noexcept {
+    for (std::size_t i = 0; i != Capacity; ++i)
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  task_queue(const task_queue&) = delete;
+  task_queue& operator=(const task_queue&) = delete;
+
+  /// constructs a task of type T from args in a free slot. Can be called from
+  /// any thread.
+  /// @returns false if the queue is full
+  template<typename T, typename... Args>
+  bool try_emplace(Args&&... args) {
+    std::size_t pos = 0;
+    slot* s = claim(pos);
+    if (s == nullptr)
+      return false;
+    // publish the slot also if the constructor of T throws. The consumer
+    // skips it, because the task is empty.
+    publisher guard{s->sequence, pos + 1};
+    s->task.template emplace<T>(std::forward<Args>(args)...);
+    return true;
+  }
+
+  /// constructs a task from f in a free slot. Can be called from any thread.
+  /// @returns false if the queue is full
+  template<typename F>
+  bool try_push(F&& f) {
+    return try_emplace<std::decay_t<F>>(std::forward<F>(f));
+  }
+
+  /// runs the oldest task in its slot. Must only be called by the consumer.
+  /// @returns false if the queue is empty
+  bool try_run() {
+    slot& s = slots_[dequeue_pos_ & (Capacity - 1)];
+    if (s.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+      return false;
+    // free the slot also if the task throws. The task is already destroyed
+    // by then.
+    publisher guard{s.sequence, dequeue_pos_ + Capacity};
+    ++dequeue_pos_;
+    if (s.task)
+      s.task();
+    return true;
+  }
+
+  /// runs tasks until the queue is empty. Must only be called by the
+  /// consumer.
+  /// @returns the number of tasks run
+  std::size_t run_all() {
+    std::size_t count = 0;
+    while (try_run())
+      ++count;
+    return count;
+  }
+
+  /// returns true if the queue holds no published task. Must only be called
+  /// by the consumer.
+  bool empty() const noexcept {
+    return slots_[dequeue_pos_ & (Capacity - 1)].sequence.load(
+               std::memory_order_acquire) != dequeue_pos_ + 1;
+  }
+
+  static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+  struct alignas(config::cache_line_size) slot {
+    std::atomic<std::size_t> sequence{0};
+    task_type task;
+  };
+
+  /// stores value in sequence with release semantics on destruction.
+  struct publisher {
+    ~publisher() { sequence.store(value, std::memory_order_release); }
+    std::atomic<std::size_t>& sequence;
+    std::size_t value;
+  };
+
+  /// reserves a free slot for the calling producer and stores its position
+  /// in pos, or returns nullptr if the queue is full.
+  slot* claim(std::size_t& pos) noexcept {
+    pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      slot& s = slots_[pos & (Capacity - 1)];
+      const std::size_t seq = s.sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+          return &s;
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  slot slots_[Capacity];
+  alignas(config::cache_line_size) std::atomic<std::size_t> enqueue_pos_{0};
+  alignas(config::cache_line_size) std::size_t dequeue_pos_{0};
+};
+} // namespace poly
+#endif
@@ -552,6 +552,26 @@ template<typename T>
 inline constexpr bool is_storage_v = traits::is_storage_v<T>;
 /// @}
 
+/// Trait for types whose objects can be moved to another address by copying
+/// their bytes, skipping the move constructor and the destructor of the
+/// source. Storages relocate objects of such types with memcpy when they are
+/// moved. Trivially copyable types are detected automatically. Other types,
+/// e.g. types owning memory through a pointer, opt in by specializing the
+/// trait:
+///
+/// ```
+/// template<>
+/// struct poly::is_trivially_relocatable<my_string> : std::true_type {};
+/// ```
+/// @{
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+/// @}
+
 #if __cplusplus > 201703L
 // enabled if c++ std > c++17
 /** @concept Storage
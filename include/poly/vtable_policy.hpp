@@ -0,0 +1,160 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef POLY_VTABLE_POLICY_HPP
+#define POLY_VTABLE_POLICY_HPP
+#include "poly/config.hpp"
+#include "poly/type_list.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace poly {
+/// @addtogroup vtable_policy VTable Policies
+/// VTable policies select how Structs and Interfaces store and access the
+/// method and property tables of the object they are bound to.
+/// @{
+
+/// Default policy for Structs. The Struct holds a pointer to its static table,
+/// and every call loads the method from that table.
+struct pointer_vtable {};
+
+/// Inline policy for Structs. The Struct stores a copy of its method entries
+/// in the object itself, in addition to the pointer to its static table. Calls
+/// load the method directly from the object, removing the dependent load
+/// through the table pointer. Each method adds the size of one function
+/// pointer to the Struct. Properties are still accessed through the static
+/// table.
+struct inline_vtable {};
+
+/// Selects inline_vtable for Structs with at most MaxInlineMethods methods,
+/// and pointer_vtable otherwise. MaxInlineMethods defaults to
+/// POLY_MAX_INLINE_METHOD_COUNT, which defaults to 3.
+template<std::size_t MaxInlineMethods = config::max_inline_method_count>
+struct auto_vtable {};
+
+/// Default policy for Interfaces. The Interface adapts the table of the
+/// Struct it is created from by storing one offset per method and property
+/// into that table. Conversions are cheap, but every call performs pointer
+/// arithmetic, and the size of the Interface grows with the number of
+/// methods and properties.
+struct offset_vtable {};
+
+/// Flat policy for Interfaces. The Interface holds a single pointer to a
+/// dense table containing exactly its own methods and properties, laid out in
+/// the same way as the table of a Struct. Calls are one load plus one
+/// indirect call, and the size of the Interface is the size of its storage
+/// plus one pointer.
+///
+/// Tables for Interfaces created directly from a T are constexpr. Tables for
+/// Interfaces created from a Struct or another flat Interface are
+/// materialised once per (source table, Interface) pair on the first
+/// conversion and reused afterwards.
+struct flat_vtable {};
+
+/// Marks a @ref MethodSpec as hot. Hot methods are placed first in the method
+/// table, directly after the type information, so that they share the first
+/// cache line of the table. Use it in the list of MethodSpecs of a Struct or
+/// Interface, i.e. POLY_METHODS(poly::hot<void(update, float)>, void(draw)).
+template<typename MethodSpec>
+struct hot {};
+
+/// Marks a @ref MethodSpec as cold. Cold methods, e.g. debug printing or
+/// serialization, are placed last in the method table.
+template<typename MethodSpec>
+struct cold {};
+
+/// @}
+
+namespace detail {
+  template<typename Policy>
+  inline constexpr bool is_flat_vtable_v = std::is_same_v<Policy, flat_vtable>;
+
+  /// resolves the vtable policy of a Struct with MethodCount methods to
+  /// either pointer_vtable or inline_vtable.
+  /// @{
+  template<typename Policy, std::size_t MethodCount>
+  struct resolve_vtable_policy {
+    static_assert(std::is_same_v<Policy, pointer_vtable> or
+                      std::is_same_v<Policy, inline_vtable>,
+                  "The vtable policy of a Struct must be pointer_vtable, "
+                  "inline_vtable or auto_vtable.");
+    using type = Policy;
+  };
+  template<std::size_t MaxInlineMethods, std::size_t MethodCount>
+  struct resolve_vtable_policy<auto_vtable<MaxInlineMethods>, MethodCount> {
+    using type = std::conditional_t<(MethodCount <= MaxInlineMethods),
+                                    inline_vtable, pointer_vtable>;
+  };
+  template<typename Policy, std::size_t MethodCount>
+  using resolve_vtable_policy_t =
+      typename resolve_vtable_policy<Policy, MethodCount>::type;
+  /// @}
+
+  /// layout rank and unwrapped spec of a @ref MethodSpec, which may be
+  /// wrapped in hot or cold.
+  /// @{
+  template<typename MethodSpec>
+  struct method_temperature {
+    static constexpr int value = 1;
+    using type = MethodSpec;
+  };
+  template<typename MethodSpec>
+  struct method_temperature<hot<MethodSpec>> {
+    static constexpr int value = 0;
+    using type = MethodSpec;
+  };
+  template<typename MethodSpec>
+  struct method_temperature<cold<MethodSpec>> {
+    static constexpr int value = 2;
+    using type = MethodSpec;
+  };
+  /// @}
+
+  template<typename... Lists>
+  struct join_lists;
+  template<template<typename...> typename L, typename... Ts>
+  struct join_lists<L<Ts...>> {
+    using type = L<Ts...>;
+  };
+  template<template<typename...> typename L, typename... Ts, typename... Us,
+           typename... Rest>
+  struct join_lists<L<Ts...>, L<Us...>, Rest...>
+      : join_lists<L<Ts..., Us...>, Rest...> {};
+
+  /// orders a list of @ref MethodSpec "MethodSpecs" into hot, unmarked and
+  /// cold methods, and removes the hot and cold wrappers. The relative order
+  /// of methods with the same mark is kept.
+  /// @{
+  template<POLY_TYPE_LIST MethodSpecs>
+  struct arrange_methods;
+  template<template<typename...> typename L, typename... MethodSpecs>
+  struct arrange_methods<L<MethodSpecs...>> {
+    template<int Temperature>
+    using with = typename join_lists<
+        L<>, std::conditional_t<
+                 method_temperature<MethodSpecs>::value == Temperature,
+                 L<typename method_temperature<MethodSpecs>::type>,
+                 L<>>...>::type;
+
+    using type =
+        typename join_lists<with<0>, with<1>, with<2>>::type;
+  };
+  template<POLY_TYPE_LIST MethodSpecs>
+  using arrange_methods_t = typename arrange_methods<MethodSpecs>::type;
+  /// @}
+} // namespace detail
+} // namespace poly
+#endif
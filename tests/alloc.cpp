@@ -0,0 +1,127 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "poly/alloc.hpp"
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+  bool is_aligned(const void* p, std::size_t align) {
+    return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+  }
+} // namespace
+
+TEST_CASE("mem_alloc", "[alloc]") {
+  for (std::size_t align : {8, 16, 32, 64, 128}) {
+    for (std::size_t size : {1, 16, 100, 129, 1000, 1024, 4000}) {
+      void* p = poly::detail::mem_alloc(size, align);
+      REQUIRE(p != nullptr);
+      REQUIRE(is_aligned(p, align));
+      std::memset(p, 0xff, size);
+      poly::detail::mem_free(p);
+    }
+  }
+  poly::detail::mem_free(nullptr);
+}
+
+TEST_CASE("poly::allocator", "[alloc]") {
+  struct alignas(64) Overaligned {
+    char c;
+  };
+  poly::allocator<std::byte> bytes;
+  poly::allocator<Overaligned> alloc(bytes);
+  REQUIRE(alloc == bytes);
+  Overaligned* p = alloc.allocate(3);
+  REQUIRE(p != nullptr);
+  REQUIRE(is_aligned(p, 64));
+  alloc.deallocate(p, 3);
+}
+
+TEST_CASE("pool size classes", "[alloc]") {
+  using poly::detail::pool_class_index;
+  using poly::detail::pool_class_size;
+  STATIC_REQUIRE(pool_class_index(1, 8) == 0);
+  STATIC_REQUIRE(pool_class_index(128, 16) ==
+                 poly::detail::pool_size_classes + 7);
+  STATIC_REQUIRE(pool_class_index(129, 8) == 8);
+  STATIC_REQUIRE(pool_class_size(8) == 160);
+  STATIC_REQUIRE(pool_class_index(1024, 64) ==
+                 poly::detail::pool_size_classes *
+                         poly::detail::pool_align_classes -
+                     1);
+  STATIC_REQUIRE(pool_class_size(pool_class_index(1024, 64)) == 1024);
+}
+
+#if POLY_USE_POOLED_ALLOC
+TEST_CASE("pooled mem_alloc", "[alloc]") {
+  using poly::detail::mem_alloc;
+  using poly::detail::mem_free;
+  poly::release_pool();
+  const poly::pool_statistics start = poly::pool_stats();
+  REQUIRE(start.cached_blocks == 0);
+  REQUIRE(start.cached_bytes == 0);
+
+  SECTION("freed blocks are reused for the same size class") {
+    void* p = mem_alloc(100, 16);
+    mem_free(p);
+    REQUIRE(poly::pool_stats().cached_blocks == 1);
+    REQUIRE(poly::pool_stats().cached_bytes == 112);
+    void* q = mem_alloc(110, 16);
+    REQUIRE(q == p);
+    const poly::pool_statistics stats = poly::pool_stats();
+    REQUIRE(stats.pool_hits == start.pool_hits + 1);
+    REQUIRE(stats.allocations == start.allocations + 2);
+    REQUIRE(stats.deallocations == start.deallocations + 1);
+    REQUIRE(stats.cached_blocks == 0);
+    mem_free(q);
+  }
+  SECTION("blocks are not reused for other alignments") {
+    void* p = mem_alloc(100, 16);
+    mem_free(p);
+    void* q = mem_alloc(100, 64);
+    REQUIRE(is_aligned(q, 64));
+    REQUIRE(poly::pool_stats().pool_hits == start.pool_hits);
+    REQUIRE(poly::pool_stats().cached_blocks == 1);
+    mem_free(q);
+  }
+  SECTION("large blocks are not cached") {
+    mem_free(mem_alloc(4096, 16));
+    mem_free(mem_alloc(64, 128));
+    REQUIRE(poly::pool_stats().cached_blocks == 0);
+  }
+  SECTION("the cache of a size class is bounded") {
+    std::vector<void*> blocks;
+    for (std::size_t i = 0; i != 2 * poly::config::pool_cache_size / 1024; ++i)
+      blocks.push_back(mem_alloc(1024, 16));
+    for (void* p : blocks)
+      mem_free(p);
+    REQUIRE(poly::pool_stats().cached_bytes <= poly::config::pool_cache_size);
+  }
+  SECTION("blocks may be freed on another thread") {
+    void* p = nullptr;
+    std::thread([&] { p = mem_alloc(64, 16); }).join();
+    mem_free(p);
+    REQUIRE(poly::pool_stats().cached_blocks == 1);
+    REQUIRE(mem_alloc(64, 16) == p);
+    mem_free(p);
+  }
+  poly::release_pool();
+  REQUIRE(poly::pool_stats().cached_blocks == 0);
+  REQUIRE(poly::pool_stats().cached_bytes == 0);
+}
+#endif
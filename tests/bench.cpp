@@ -0,0 +1,414 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "poly.hpp"
+#include "poly/function.hpp"
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// micro benchmarks for the hot paths of the library. Build in release mode
+// and run the bench executable. The numbers are only meaningful relative to
+// each other.
+
+POLY_METHOD(bm1);
+POLY_METHOD(bm2);
+POLY_METHOD(bm3);
+POLY_METHOD(bm4);
+POLY_PROPERTY(bp1);
+
+namespace {
+  /// keeps the compiler from optimizing value away
+  template<typename T>
+  void sink(T&& value) {
+    auto v = static_cast<std::size_t>(value);
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(v) : "memory");
+#else
+    static std::atomic<std::size_t> storage;
+    storage.store(v, std::memory_order_relaxed);
+#endif
+  }
+
+  /// runs f(i) for i in [0, iterations) and prints the time per iteration.
+  /// The best of several runs is reported.
+  template<typename F>
+  void bench(const char* name, std::size_t iterations, F&& f) {
+    using clock = std::chrono::steady_clock;
+    double best = 0;
+    for (int run = 0; run != 5; ++run) {
+      const auto start = clock::now();
+      for (std::size_t i = 0; i != iterations; ++i)
+        f(i);
+      const auto end = clock::now();
+      const double ns =
+          std::chrono::duration<double, std::nano>(end - start).count();
+      if (run == 0 or ns < best)
+        best = ns;
+    }
+    std::cout << std::left << std::setw(48) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2)
+              << best / static_cast<double>(iterations) << " ns/iter"
+              << std::endl;
+  }
+
+  /// objects of four different types, to keep the branch predictor busy
+  template<std::size_t I>
+  struct Obj {
+    std::size_t v{I};
+  };
+  template<std::size_t I>
+  std::size_t extend(bm1, const Obj<I>& o) {
+    return o.v;
+  }
+  template<std::size_t I>
+  std::size_t extend(bm2, const Obj<I>& o) {
+    return o.v + 1;
+  }
+  template<std::size_t I>
+  std::size_t extend(bm3, const Obj<I>& o) {
+    return o.v + 2;
+  }
+  template<std::size_t I>
+  std::size_t extend(bm4, const Obj<I>& o) {
+    return o.v + 3;
+  }
+  template<std::size_t I>
+  int get(bp1, const Obj<I>& o) {
+    return static_cast<int>(o.v);
+  }
+  template<std::size_t I>
+  void set(bp1, Obj<I>& o, const int& v) {
+    o.v = static_cast<std::size_t>(v);
+  }
+
+  using Properties = POLY_PROPERTIES(bp1(int));
+  using Methods =
+      POLY_METHODS(std::size_t(bm1) const, std::size_t(bm2) const,
+                   std::size_t(bm3) const, std::size_t(bm4) const);
+  using Ref = poly::Reference<Properties, Methods>;
+  using IRef =
+      poly::InterfaceRef<Properties,
+                         POLY_METHODS(std::size_t(bm1) const,
+                                      std::size_t(bm3) const)>;
+  using IRef2 =
+      poly::InterfaceRef<poly::type_list<>,
+                         POLY_METHODS(std::size_t(bm3) const)>;
+
+  void interface_conversion(std::size_t n) {
+    Obj<0> o0;
+    Obj<1> o1;
+    Obj<2> o2;
+    Obj<3> o3;
+    Ref refs[] = {o0, o1, o2, o3};
+    IRef irefs[] = {refs[0], refs[1], refs[2], refs[3]};
+    bench("Struct -> Interface conversion", n, [&](std::size_t i) {
+      IRef iref(refs[i % 4]);
+      sink(iref.call<bm3>());
+    });
+    bench("Interface -> Interface conversion", n, [&](std::size_t i) {
+      IRef2 iref2(irefs[i % 4]);
+      sink(iref2.call<bm3>());
+    });
+    bench("Struct call", n, [&](std::size_t i) {
+      sink(refs[i % 4].call<bm3>());
+    });
+    bench("Interface call", n, [&](std::size_t i) {
+      sink(irefs[i % 4].call<bm3>());
+    });
+  }
+
+  /// allocation churn of short lived objects, compare builds with and
+  /// without POLY_POOLED_ALLOC.
+  void heap_churn(std::size_t n) {
+    struct Big {
+      std::size_t v;
+      std::byte pad[120];
+    };
+    bench("heap_storage emplace + destroy", n, [&](std::size_t i) {
+      poly::heap_storage s;
+      sink(s.emplace<Obj<0>>(Obj<0>{i})->v);
+    });
+    bench("sbo_storage spill emplace + destroy", n, [&](std::size_t i) {
+      poly::sbo_storage<32> s;
+      sink(s.emplace<Big>(Big{i, {}})->v);
+    });
+  }
+
+  /// allocation churn of small oversized objects, served by the heap and by
+  /// an arena. The object is small, so copying it does not dominate.
+  void arena_churn(std::size_t n) {
+    struct Big {
+      std::size_t v;
+      std::byte pad[40];
+    };
+    bench("sbo_storage spill of 48 byte object", n, [&](std::size_t i) {
+      poly::sbo_storage<32> s;
+      sink(s.emplace<Big>(Big{i, {}})->v);
+    });
+    poly::arena arena;
+    bench("arena_storage spill of 48 byte object", n, [&](std::size_t i) {
+      if (i % 1024 == 0)
+        arena.release();
+      poly::arena_storage<32> s(arena);
+      sink(s.emplace<Big>(Big{i, {}})->v);
+    });
+  }
+
+  /// copying a storage holding a large object
+  void struct_copy(std::size_t n) {
+    struct Payload {
+      std::size_t v;
+      std::byte pad[248];
+    };
+    using Shared = poly::Struct<poly::shared_storage, Properties, Methods>;
+    const Shared shared{Obj<0>{}};
+    const Payload payload{1, {}};
+    poly::sbo_storage<32> sbo_storage;
+    sbo_storage.emplace<Payload>(payload);
+    poly::shared_storage shared_storage;
+    shared_storage.emplace<Payload>(payload);
+    bench("sbo_storage copy of 256 byte object", n, [&](std::size_t) {
+      poly::sbo_storage<32> copy(sbo_storage);
+      sink(static_cast<const Payload*>(copy.data())->v);
+    });
+    bench("shared_storage copy of 256 byte object", n, [&](std::size_t) {
+      poly::shared_storage copy(shared_storage);
+      sink(static_cast<const Payload*>(copy.data())->v);
+    });
+    bench("Struct<shared_storage> copy", n, [&](std::size_t) {
+      Shared copy(shared);
+      sink(copy.call<bm1>());
+    });
+  }
+
+  /// method calls through sbo_storage, which finds the object through its
+  /// resource table, and cached_sbo_storage, which keeps a pointer to it.
+  void sbo_call(std::size_t n) {
+    using Sbo = poly::Struct<poly::sbo_storage<32>, Properties, Methods>;
+    using Cached =
+        poly::Struct<poly::cached_sbo_storage<32>, Properties, Methods>;
+    Sbo sbo[] = {Obj<0>{}, Obj<1>{}, Obj<2>{}, Obj<3>{}};
+    Cached cached[] = {Obj<0>{}, Obj<1>{}, Obj<2>{}, Obj<3>{}};
+    bench("Struct<sbo_storage> call", n, [&](std::size_t i) {
+      sink(sbo[i % 4].call<bm3>());
+    });
+    bench("Struct<cached_sbo_storage> call", n, [&](std::size_t i) {
+      sink(cached[i % 4].call<bm3>());
+    });
+  }
+
+  /// moving Structs, as done by std::vector when it grows. Obj is trivially
+  /// copyable and relocated with memcpy, Pinned has a user provided move
+  /// constructor and is moved through the resource table.
+  struct Pinned {
+    Pinned(std::size_t v) : v(v) {}
+    Pinned(Pinned&& other) noexcept : v(other.v) {}
+    Pinned(const Pinned& other) = default;
+    std::size_t v;
+  };
+  std::size_t extend(bm1, const Pinned& p) { return p.v; }
+
+  void struct_move(std::size_t n) {
+    using Local = poly::Struct<poly::local_storage<64>, poly::type_list<>,
+                               POLY_METHODS(std::size_t(bm1) const)>;
+    Local relocatable{Obj<0>{}};
+    Local pinned{Pinned{0}};
+    bench("Struct<local_storage> move, relocatable", n, [&](std::size_t) {
+      Local tmp(std::move(relocatable));
+      relocatable = std::move(tmp);
+      sink(relocatable.call<bm1>());
+    });
+    bench("Struct<local_storage> move, not relocatable", n, [&](std::size_t) {
+      Local tmp(std::move(pinned));
+      pinned = std::move(tmp);
+      sink(pinned.call<bm1>());
+    });
+  }
+
+  /// alternative with non trivial copy constructor and destructor, so that
+  /// copies dispatch on the index of the active alternative.
+  template<std::size_t I>
+  struct Alt {
+    Alt(std::size_t v) : v(v) {}
+    Alt(const Alt& other) : v(other.v + I) {}
+    ~Alt() { sink(v); }
+    std::size_t v;
+  };
+
+  template<std::size_t... Is>
+  void variant_copy(std::index_sequence<Is...>, std::size_t n) {
+    constexpr std::size_t count = sizeof...(Is);
+    using Storage = poly::variant_storage<Alt<Is>...>;
+    using Variant = std::variant<Alt<Is>...>;
+    std::vector<Storage> storages(64);
+    std::vector<Variant> variants;
+    // every alternative is active in one of the variants
+    (((void)(storages[Is % 64].template emplace<Alt<Is>>(Is)),
+      variants.emplace_back(std::in_place_index<Is>, Is)),
+     ...);
+    for (std::size_t i = count; i < 64; ++i) {
+      storages[i] = storages[i % count];
+      variants.push_back(variants[i % count]);
+    }
+    const std::string size = std::to_string(count);
+    bench(("variant_storage copy, " + size + " types").c_str(), n,
+          [&](std::size_t j) {
+            Storage copy(storages[(j * 7) % 64]);
+            sink(copy.data() != nullptr);
+          });
+    bench(("std::variant copy, " + size + " types").c_str(), n,
+          [&](std::size_t j) {
+            Variant copy(variants[(j * 7) % 64]);
+            sink(copy.index());
+          });
+  }
+
+  void variant_copy(std::size_t n) {
+    variant_copy(std::make_index_sequence<4>{}, n);
+    variant_copy(std::make_index_sequence<16>{}, n);
+    variant_copy(std::make_index_sequence<64>{}, n);
+  }
+
+  /// calls on a closed set of types, through the method table of a Struct,
+  /// with the index switch of a ClosedStruct, and with std::visit.
+  void closed_call(std::size_t n) {
+    using Types = poly::type_list<Obj<0>, Obj<1>, Obj<2>, Obj<3>>;
+    using Open =
+        poly::Struct<poly::variant_storage<Obj<0>, Obj<1>, Obj<2>, Obj<3>>,
+                     Properties, Methods>;
+    using Closed = poly::ClosedStruct<Types, Properties, Methods>;
+    using Variant = std::variant<Obj<0>, Obj<1>, Obj<2>, Obj<3>>;
+    Open open[] = {Obj<0>{}, Obj<1>{}, Obj<2>{}, Obj<3>{}};
+    Closed closed[] = {Obj<0>{}, Obj<1>{}, Obj<2>{}, Obj<3>{}};
+    Variant variants[] = {Obj<0>{}, Obj<1>{}, Obj<2>{}, Obj<3>{}};
+    bench("Struct<variant_storage> call", n, [&](std::size_t i) {
+      sink(open[(i * 7) % 4].call<bm3>());
+    });
+    bench("ClosedStruct call", n, [&](std::size_t i) {
+      sink(closed[(i * 7) % 4].call<bm3>());
+    });
+    bench("std::visit", n, [&](std::size_t i) {
+      sink(std::visit([](const auto& o) { return extend(bm3{}, o); },
+                      variants[(i * 7) % 4]));
+    });
+  }
+
+  /// task capturing a buffer, which is expensive to move. It is not trivially
+  /// copyable, so that moves are not turned into memcpy.
+  struct Task {
+    Task(std::size_t v) { buffer.fill(v); }
+    Task(Task&& other) noexcept : buffer(other.buffer) {}
+    std::size_t operator()() { return buffer[buffer.size() - 1]; }
+    std::array<std::size_t, 32> buffer;
+  };
+
+  /// the invocation path once_function used before: the callable is moved
+  /// to the stack and the storage is reset before the call.
+  template<typename Storage, typename F>
+  std::size_t move_out_once(Storage& storage) {
+    F f = std::move(*static_cast<F*>(storage.data()));
+    storage = Storage{};
+    return f();
+  }
+
+  /// binding and invoking a task. once_function invokes the task where it is
+  /// stored, the move out path moves it to the stack first.
+  void once_call(std::size_t n) {
+    using Storage = poly::move_only_local_storage<sizeof(Task)>;
+    using Once = poly::once_function<std::size_t(), Storage>;
+    Once once;
+    bench("once_function call, in place", n, [&](std::size_t i) {
+      once.bind(Task{i});
+      sink(once());
+    });
+    Storage storage;
+    static std::size_t (*volatile move_out)(Storage&) =
+        move_out_once<Storage, Task>;
+    bench("once_function call, move out", n, [&](std::size_t i) {
+      storage.emplace<Task>(Task{i});
+      sink(move_out(storage));
+    });
+#ifdef __cpp_lib_move_only_function
+    std::move_only_function<std::size_t()> std_once;
+    bench("std::move_only_function call", n, [&](std::size_t i) {
+      std_once = Task{i};
+      sink(std::exchange(std_once, nullptr)());
+    });
+#endif
+  }
+
+  std::size_t add_one(std::size_t i) { return i + 1; }
+
+  /// calling a callback through a reference to it
+  void ref_call(std::size_t n) {
+    std::size_t offset = 1;
+    auto callback = [&offset](std::size_t i) { return i + offset; };
+    poly::function<std::size_t(std::size_t), poly::ref_storage> fn{
+        callback};
+    bench("function<ref_storage> call", n,
+          [&](std::size_t i) { sink(fn(i)); });
+    const poly::function_ref<std::size_t(std::size_t)> ref{callback};
+    bench("function_ref call", n, [&](std::size_t i) { sink(ref(i)); });
+    const poly::function_ref<std::size_t(std::size_t)> fn_ref{add_one};
+    bench("function_ref call, function pointer", n,
+          [&](std::size_t i) { sink(fn_ref(i)); });
+  }
+
+  /// copying and calling a trivially copyable callback. inplace_function
+  /// copies it with memcpy, function<local_storage> through its
+  /// resource_table and std::function may allocate.
+  void inplace_copy(std::size_t n) {
+    std::size_t a = 1, b = 2, c = 3;
+    auto callback = [a, b, c](std::size_t i) { return i + a + b + c; };
+    using Sig = std::size_t(std::size_t) const;
+    const poly::inplace_function<Sig, 32> inplace{callback};
+    bench("inplace_function copy and call", n, [&](std::size_t i) {
+      const auto copy = inplace;
+      sink(copy(i));
+    });
+    const poly::function<Sig, poly::local_storage<32>> local{callback};
+    bench("function<local_storage> copy and call", n, [&](std::size_t i) {
+      const auto copy = local;
+      sink(copy(i));
+    });
+    const std::function<std::size_t(std::size_t)> std_fn{callback};
+    bench("std::function copy and call", n, [&](std::size_t i) {
+      const auto copy = std_fn;
+      sink(copy(i));
+    });
+  }
+} // namespace
+
+int main() {
+  constexpr std::size_t n = 10'000'000;
+  // called through volatile pointers, so that the benchmarks are not inlined
+  // into main, which compilers optimize for size
+  using benchmark = void (*)(std::size_t);
+  static volatile benchmark benchmarks[] = {
+      interface_conversion, heap_churn,   arena_churn, struct_copy,
+      sbo_call,             struct_move,  variant_copy, closed_call,
+      once_call,            ref_call,     inplace_copy};
+  for (benchmark b : benchmarks)
+    b(n);
+}
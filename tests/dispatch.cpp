@@ -0,0 +1,329 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "poly.hpp"
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+POLY_METHOD(area);
+POLY_METHOD(scale);
+POLY_PROPERTY(name);
+
+struct Circle {
+  int r;
+};
+struct Square {
+  int a;
+};
+struct Triangle {
+  int b;
+  int h;
+};
+
+constexpr int extend(area, const Circle& c) { return 3 * c.r * c.r; }
+constexpr int extend(area, const Square& s) { return s.a * s.a; }
+constexpr int extend(area, const Triangle& t) { return t.b * t.h / 2; }
+constexpr void extend(scale, Circle& c, int f) { c.r *= f; }
+constexpr void extend(scale, Square& s, int f) { s.a *= f; }
+constexpr void extend(scale, Triangle& t, int f) {
+  t.b *= f;
+  t.h *= f;
+}
+const char* get(name, const Circle&) { return "circle"; }
+const char* get(name, const Square&) { return "square"; }
+const char* get(name, const Triangle&) { return "triangle"; }
+
+using Shape = poly::Struct<poly::sbo_storage<16>,
+                           POLY_PROPERTIES(const name(const char*)),
+                           POLY_METHODS(int(area) const, void(scale, int))>;
+using AreaRef = poly::InterfaceRef<POLY_PROPERTIES(),
+                                   POLY_METHODS(int(area) const)>;
+using FlatAreaRef =
+    poly::FlatInterfaceRef<POLY_PROPERTIES(), POLY_METHODS(int(area) const)>;
+
+TEST_CASE("Struct::holds/target", "[dispatch]") {
+  Shape shape{Circle{2}};
+  REQUIRE(shape.holds<Circle>());
+  REQUIRE_FALSE(shape.holds<Square>());
+  REQUIRE(shape.target<Circle>() != nullptr);
+  REQUIRE(shape.target<Circle>()->r == 2);
+  REQUIRE(shape.target<Square>() == nullptr);
+
+  AreaRef ref{shape};
+  REQUIRE(ref.holds<Circle>());
+  REQUIRE_FALSE(ref.holds<Square>());
+  REQUIRE(ref.target<Circle>() == shape.target<Circle>());
+
+  FlatAreaRef flat{shape};
+  REQUIRE(flat.holds<Circle>());
+  REQUIRE_FALSE(flat.holds<Triangle>());
+  REQUIRE(flat.target<Circle>() == shape.target<Circle>());
+}
+
+TEST_CASE("call_as", "[dispatch]") {
+  Shape shape{Circle{2}};
+  SECTION("listed type") {
+    REQUIRE(shape.call_as<area, Square, Circle>() == 12);
+    shape.call_as<scale, Circle>(2);
+    REQUIRE(shape.target<Circle>()->r == 4);
+  }
+  SECTION("type not listed") {
+    shape = Triangle{2, 3};
+    REQUIRE(shape.call_as<area, Square, Circle>() == 3);
+    shape.call_as<scale, Circle, Square>(2);
+    REQUIRE(shape.call_as<area>() == 12);
+  }
+  SECTION("const") {
+    const Shape& cshape = shape;
+    REQUIRE(cshape.call_as<area, Circle>() == 12);
+  }
+  SECTION("Interface") {
+    AreaRef ref{shape};
+    REQUIRE(ref.call_as<area, Circle>() == 12);
+    REQUIRE(ref.call_as<area, Square>() == 12);
+    Square square{3};
+    FlatAreaRef flat{square};
+    REQUIRE(flat.call_as<area, Square>() == 9);
+    REQUIRE(flat.call_as<area, Circle>() == 9);
+  }
+}
+
+TEST_CASE("visit_as", "[dispatch]") {
+  Shape shapes[] = {Circle{1}, Square{2}, Triangle{2, 2}};
+  int total = 0;
+  for (auto& s : shapes)
+    total += poly::visit_as<Circle, Square>(s).call<area>();
+  REQUIRE(total == 9);
+  for (auto& s : shapes)
+    poly::visit_as<Circle, Square>(s).call<scale>(2);
+  total = 0;
+  for (auto& s : shapes) {
+    AreaRef ref{s};
+    total += poly::visit_as<Triangle>(ref).call<area>();
+  }
+  REQUIRE(total == 36);
+}
+
+TEST_CASE("for_each_call", "[dispatch]") {
+  std::vector<Shape> shapes;
+  for (int i = 0; i < 30; ++i) {
+    switch (i % 3) {
+    case 0: shapes.emplace_back(Circle{1}); break;
+    case 1: shapes.emplace_back(Square{1}); break;
+    case 2: shapes.emplace_back(Triangle{2, 1}); break;
+    }
+  }
+  SECTION("groups") {
+    poly::call_groups<Shape> groups(shapes);
+    REQUIRE(groups.size() == 30);
+    REQUIRE(groups.group_count() == 3);
+    groups.call<scale>(2);
+    poly::call_groups<const Shape> const_groups(std::as_const(shapes));
+    REQUIRE(const_groups.group_count() == 3);
+  }
+  SECTION("Struct") {
+    poly::for_each_call<scale>(shapes, 2);
+  }
+  SECTION("Interface") {
+    std::vector<poly::InterfaceRef<POLY_PROPERTIES(),
+                                   POLY_METHODS(void(scale, int))>>
+        refs(shapes.begin(), shapes.end());
+    poly::for_each_call<scale>(refs, 2);
+  }
+  SECTION("FlatInterface") {
+    std::vector<poly::FlatInterfaceRef<POLY_PROPERTIES(),
+                                       POLY_METHODS(void(scale, int))>>
+        refs(shapes.begin(), shapes.end());
+    poly::for_each_call<scale>(refs, 2);
+  }
+  int total = 0;
+  for (const auto& s : shapes)
+    total += s.call<area>();
+  REQUIRE(total == 10 * (12 + 4 + 4));
+}
+
+TEST_CASE("for_each_call with cow_storage", "[dispatch]") {
+  using Cow =
+      poly::Struct<poly::cow_storage, POLY_PROPERTIES(),
+                   POLY_METHODS(int(area) const, void(scale, int))>;
+  const Cow original{Circle{1}};
+  std::vector<Cow> copies(3, original);
+  // const methods keep the objects shared
+  poly::for_each_call<area>(copies);
+  for (const Cow& c : copies)
+    REQUIRE(c.target<Circle>() == original.target<Circle>());
+  poly::for_each_call<scale>(copies, 2);
+  for (const Cow& c : copies) {
+    REQUIRE(c.target<Circle>() != original.target<Circle>());
+    REQUIRE(c.target<Circle>()->r == 2);
+  }
+  REQUIRE(original.target<Circle>()->r == 1);
+}
+
+POLY_METHOD(record);
+void extend(record, const Circle& c, std::vector<int>& out) {
+  out.push_back(c.r);
+}
+void extend(record, const Square& s, std::vector<int>& out) {
+  out.push_back(100 + s.a);
+}
+void extend(record, const Triangle& t, std::vector<int>& out) {
+  out.push_back(200 + t.b);
+}
+
+TEST_CASE("for_each_call order", "[dispatch]") {
+  using Recorder =
+      poly::Struct<poly::sbo_storage<16>, POLY_PROPERTIES(),
+                   POLY_METHODS(void(record, std::vector<int>&) const)>;
+  std::vector<Recorder> objects;
+  for (int i = 0; i < 9; ++i) {
+    switch (i % 3) {
+    case 0: objects.emplace_back(Circle{i}); break;
+    case 1: objects.emplace_back(Square{i}); break;
+    case 2: objects.emplace_back(Triangle{i, 1}); break;
+    }
+  }
+  // groups are called in the order of their first element, and elements in
+  // the order of the range
+  const std::vector<int> expected{0, 3, 6, 101, 104, 107, 202, 205, 208};
+  std::vector<int> out;
+  poly::for_each_call<record>(objects, out);
+  REQUIRE(out == expected);
+  // the reused groups of the second call must not contain the first range
+  out.clear();
+  objects.pop_back();
+  poly::for_each_call<record>(objects, out);
+  REQUIRE(out == std::vector<int>{0, 3, 6, 101, 104, 107, 202, 205});
+}
+
+POLY_METHOD(consume);
+void extend(consume, Circle& c, std::unique_ptr<int> p) { c.r += *p; }
+void extend(consume, Square& s, std::unique_ptr<int> p) { s.a += *p; }
+void extend(consume, Triangle& t, std::unique_ptr<int> p) { t.b += *p; }
+
+TEST_CASE("batch trampolines", "[dispatch]") {
+  using Spec = void(scale, int);
+  Circle circles[] = {{1}, {2}, {3}};
+  void* objs[] = {&circles[0], &circles[1], &circles[2]};
+  poly::detail::trampoline<Spec>::jump_batch<Circle>(scale{}, objs, 3, 3);
+  REQUIRE(circles[0].r == 3);
+  REQUIRE(circles[1].r == 6);
+  REQUIRE(circles[2].r == 9);
+
+  constexpr auto& table =
+      poly::detail::batch_table_for<Square, POLY_METHODS(int(area) const,
+                                                         void(scale, int))>;
+  Square squares[] = {{1}, {2}};
+  const void* cobjs[] = {&squares[0], &squares[1]};
+  table(area{}, cobjs, 2);
+  void* sobjs[] = {&squares[0], &squares[1]};
+  table(scale{}, sobjs, 2, 2);
+  REQUIRE(squares[0].a == 2);
+  REQUIRE(squares[1].a == 4);
+
+  using MoveOnly =
+      poly::Struct<poly::sbo_storage<16>, POLY_PROPERTIES(),
+                   POLY_METHODS(void(consume, std::unique_ptr<int>),
+                                void(scale, int))>;
+  using AreaIf =
+      poly::InterfaceRef<POLY_PROPERTIES(), POLY_METHODS(void(scale, int))>;
+  using FlatAreaIf =
+      poly::FlatInterfaceRef<POLY_PROPERTIES(), POLY_METHODS(void(scale, int))>;
+  STATIC_REQUIRE(
+      poly::detail::is_batch_callable_v<Shape, scale, void*, int>);
+  STATIC_REQUIRE(
+      poly::detail::is_batch_callable_v<FlatAreaIf, scale, void*, int>);
+  STATIC_REQUIRE_FALSE(
+      poly::detail::is_batch_callable_v<AreaIf, scale, void*, int>);
+  STATIC_REQUIRE_FALSE(
+      poly::detail::is_batch_callable_v<MoveOnly, consume, void*,
+                                        std::unique_ptr<int>>);
+  STATIC_REQUIRE(
+      poly::detail::is_batch_callable_v<MoveOnly, scale, void*, int>);
+
+  std::vector<MoveOnly> objects;
+  objects.emplace_back(Circle{1});
+  objects.emplace_back(Square{1});
+  poly::for_each_call<scale>(objects, 5);
+  REQUIRE(objects[0].target<Circle>()->r == 5);
+  REQUIRE(objects[1].target<Square>()->a == 5);
+}
+
+POLY_PROPERTY(extent);
+int get(extent, const Circle& c) { return c.r; }
+int get(extent, const Square& s) { return s.a; }
+int get(extent, const Triangle& t) { return t.b; }
+void set(extent, Circle& c, const int& v) { c.r = v; }
+void set(extent, Square& s, const int& v) { s.a = v; }
+void set(extent, Triangle& t, const int& v) { t.b = v; }
+bool check(extent, const Circle&, const int& v) { return v >= 0; }
+
+using ClosedShape =
+    poly::ClosedStruct<poly::type_list<Circle, Square, Triangle>,
+                       POLY_PROPERTIES(const name(const char*), extent(int)),
+                       POLY_METHODS(int(area) const, void(scale, int))>;
+
+static_assert(sizeof(ClosedShape) ==
+              sizeof(poly::variant_storage<Circle, Square, Triangle>));
+
+TEST_CASE("ClosedStruct", "[dispatch]") {
+  ClosedShape shape;
+  REQUIRE_FALSE(shape.is_bound());
+  REQUIRE(shape.index() == 3);
+
+  shape = Circle{2};
+  REQUIRE(shape.is_bound());
+  REQUIRE(shape.index() == 0);
+  REQUIRE(shape.holds<Circle>());
+  REQUIRE_FALSE(shape.holds<Square>());
+  REQUIRE(shape.target<Circle>()->r == 2);
+  REQUIRE(shape.target<Square>() == nullptr);
+
+  SECTION("methods") {
+    REQUIRE(shape.area() == 12);
+    shape.scale(2);
+    REQUIRE(shape.call<area>() == 48);
+    shape = Triangle{2, 3};
+    REQUIRE(shape.area() == 3);
+    shape.call<scale>(2);
+    const ClosedShape& cshape = shape;
+    REQUIRE(cshape.area() == 12);
+  }
+  SECTION("properties") {
+    REQUIRE(std::string(shape.get<name>()) == "circle");
+    REQUIRE(shape.set<extent>(3));
+    REQUIRE(shape.get<extent>() == 3);
+    // rejected by check()
+    REQUIRE_FALSE(shape.set<extent>(-1));
+    REQUIRE(shape.target<Circle>()->r == 3);
+    shape = Square{2};
+    REQUIRE(std::string(shape.get<name>()) == "square");
+    REQUIRE(shape.set<extent>(-1));
+    REQUIRE(shape.get<extent>() == -1);
+  }
+  SECTION("copy and move") {
+    ClosedShape copy(shape);
+    REQUIRE(copy.target<Circle>() != shape.target<Circle>());
+    REQUIRE(copy.area() == 12);
+    ClosedShape moved(std::move(copy));
+    REQUIRE(moved.area() == 12);
+    moved = ClosedShape{poly::traits::Id<Square>{}, Square{3}};
+    REQUIRE(moved.holds<Square>());
+    REQUIRE(moved.area() == 9);
+  }
+}
@@ -16,9 +16,10 @@
 #include "poly/function.hpp"
 #include "catch2/catch_all.hpp"
 #include "poly/storage.hpp"
+#include <memory>
 using Fn = poly::function<int(int) const, poly::local_storage<32, 8>>;
-// using Fn2 = poly::any_function<poly::local_storage<32, 8>, int(int) const,
-//                                int(float), float(double)>;
+using Fn2 = poly::any_function<poly::local_storage<32, 8>, int(int) const,
+                               int(float), float(double)>;
 
 template<typename... Ts>
 struct overload : public Ts... {
@@ -30,12 +31,194 @@ overload(Ts...) -> overload<std::decay_t<Ts>...>;
 TEST_CASE("function") {
   Fn f{[](int i) -> int { return i - 1; }};
   REQUIRE(f(43) == 42);
-  // Fn2 f2{overload{[](int i) -> int { return i - 1; },
-  //                 [](float f) mutable -> int { return f + 1; },
-  //                 [](double d) mutable -> float { return d + 2; }}};
-  // REQUIRE(f2(43i32) == 42);
-  // REQUIRE(f2(43.0f) == 44);
-  // REQUIRE(f2(43.0) == 45.0f);
-  // f.bind([](int i) -> int { return i + 1; });
-  // REQUIRE(f(43) == 44);
+  f.bind([](int i) -> int { return i + 1; });
+  REQUIRE(f(43) == 44);
+}
+
+TEST_CASE("any_function") {
+  static_assert(sizeof(Fn2) ==
+                sizeof(poly::local_storage<32, 8>) + sizeof(void*));
+  int calls = 0;
+  Fn2 f2{overload{[](int i) -> int { return i - 1; },
+                  [&calls](float f) mutable -> int {
+                    ++calls;
+                    return static_cast<int>(f) + 1;
+                  },
+                  [](double d) mutable -> float {
+                    return static_cast<float>(d + 2);
+                  }}};
+  REQUIRE(f2(43) == 42);
+  REQUIRE(f2(43.0f) == 44);
+  REQUIRE(f2(43.0) == 45.0f);
+  REQUIRE(calls == 1);
+  const Fn2& cf2 = f2;
+  REQUIRE(cf2(1) == 0);
+
+  Fn2 copy = f2;
+  REQUIRE(copy(2.0f) == 3);
+  REQUIRE(calls == 2);
+
+  f2.bind(overload{[](int i) -> int { return i * 2; },
+                   [](float) -> int { return 0; },
+                   [](double) -> float { return 1.0f; }});
+  REQUIRE(f2(21) == 42);
+  REQUIRE(f2(1.0) == 1.0f);
+  REQUIRE(copy(21) == 20);
+}
+
+namespace {
+struct Tracked {
+  Tracked(int& moves, int& destroyed) : moves(&moves), destroyed(&destroyed) {}
+  Tracked(Tracked&& other) noexcept
+      : moves(other.moves), destroyed(other.destroyed) {
+    ++*moves;
+  }
+  Tracked(const Tracked&) = delete;
+  ~Tracked() { ++*destroyed; }
+
+  int operator()(int i) {
+    if (i < 0)
+      throw i;
+    return i + *moves;
+  }
+
+  int* moves;
+  int* destroyed;
+};
+} // namespace
+
+TEST_CASE("once_function") {
+  using Once = poly::once_function<int(int), poly::move_only_local_storage<32>>;
+  int moves = 0;
+  int destroyed = 0;
+  Once f{Tracked{moves, destroyed}};
+  REQUIRE(moves == 1);
+  REQUIRE(destroyed == 1);
+  REQUIRE(f);
+
+  Once g = std::move(f);
+  REQUIRE(not f);
+  REQUIRE(g);
+  REQUIRE(moves == 2);
+
+  // the callable is invoked where it is stored and destroyed afterwards.
+  // Objects alive are the ones constructed directly or by a move, minus the
+  // destroyed ones.
+  REQUIRE(moves + 1 - destroyed == 1);
+  REQUIRE(g(40) == 42);
+  REQUIRE(moves == 2);
+  REQUIRE(moves + 1 - destroyed == 0);
+  REQUIRE(not g);
+
+  g.bind(Tracked{moves, destroyed});
+  REQUIRE(moves == 3);
+  REQUIRE(moves + 2 - destroyed == 1);
+  REQUIRE_THROWS_AS(g(-1), int);
+  REQUIRE(moves + 2 - destroyed == 0);
+  REQUIRE(not g);
+
+  Once empty;
+  REQUIRE(not empty);
+}
+
+namespace {
+int twice(int i) noexcept { return 2 * i; }
+long negate(long i) { return -i; }
+
+int apply(poly::function_ref<int(int) const> f, int i) { return f(i); }
+} // namespace
+
+TEST_CASE("function_ref") {
+  using Ref = poly::function_ref<int(int)>;
+  STATIC_REQUIRE(sizeof(Ref) == 2 * sizeof(void*));
+  STATIC_REQUIRE(std::is_trivially_copyable_v<Ref>);
+  STATIC_REQUIRE(
+      std::is_trivially_copyable_v<poly::function_ref<int(int) const noexcept>>);
+  STATIC_REQUIRE(not std::is_constructible_v<Ref, int>);
+  STATIC_REQUIRE(
+      not std::is_constructible_v<poly::function_ref<int(int) noexcept>,
+                                  int (*)(int)>);
+
+  int calls = 0;
+  auto counter = [&calls](int i) { return i + ++calls; };
+  Ref f{counter};
+  REQUIRE(f(1) == 2);
+  REQUIRE(f(1) == 3);
+  REQUIRE(calls == 2);
+
+  // copies reference the same callable
+  Ref copy = f;
+  REQUIRE(copy(1) == 4);
+
+  // functions and function pointers are stored directly
+  f = twice;
+  REQUIRE(f(21) == 42);
+  int (*fn)(int) noexcept = &twice;
+  poly::function_ref<int(int) const noexcept> g{fn};
+  fn = nullptr;
+  REQUIRE(g(2) == 4);
+  // other signatures convert the arguments and the return value
+  f = negate;
+  REQUIRE(f(3) == -3);
+
+  const auto add = [](int i) { return i + 1; };
+  REQUIRE(apply(add, 1) == 2);
+  REQUIRE(apply(twice, 3) == 6);
+
+  // owning poly functions are referenced, not copied
+  poly::function<int(int), poly::local_storage<32>> owning{counter};
+  Ref to_owning{owning};
+  REQUIRE(to_owning(1) == 5);
+  owning.bind([](int i) { return 2 * i; });
+  REQUIRE(to_owning(1) == 2);
+  const poly::inplace_function<int(int) const, 16> inplace{add};
+  REQUIRE(apply(inplace, 2) == 3);
+  STATIC_REQUIRE(std::is_constructible_v<
+                 Ref, poly::once_function<int(int), poly::local_storage<32>>&>);
+  STATIC_REQUIRE(
+      std::is_constructible_v<Ref, poly::any_function<poly::local_storage<32>,
+                                                      int(int)>&>);
+}
+
+TEST_CASE("inplace_function") {
+  using Fn = poly::inplace_function<int(int) const, 16>;
+  STATIC_REQUIRE(std::is_nothrow_move_constructible_v<Fn>);
+  STATIC_REQUIRE(std::is_nothrow_move_assignable_v<Fn>);
+  STATIC_REQUIRE(
+      noexcept(std::declval<poly::inplace_function<int(int) noexcept, 16>&>()(
+          1)));
+
+  SECTION("trivially copyable callables") {
+    int offset = 1;
+    Fn f{[offset](int i) { return i + offset; }};
+    REQUIRE(f);
+    REQUIRE(f(1) == 2);
+    Fn copy = f;
+    REQUIRE(copy(2) == 3);
+    Fn moved = std::move(copy);
+    REQUIRE(not copy);
+    REQUIRE(moved(3) == 4);
+    poly::inplace_function<int(int) const, 32> bigger = f;
+    REQUIRE(bigger(4) == 5);
+    f = [](int i) { return 2 * i; };
+    REQUIRE(f(4) == 8);
+    f.reset();
+    REQUIRE(not f);
+  }
+
+  SECTION("callables with resources") {
+    auto ptr = std::make_shared<int>(1);
+    poly::inplace_function<int(int), 16> f{[ptr](int i) { return i + *ptr; }};
+    REQUIRE(ptr.use_count() == 2);
+    auto copy = f;
+    REQUIRE(ptr.use_count() == 3);
+    auto moved = std::move(copy);
+    REQUIRE(ptr.use_count() == 3);
+    REQUIRE(moved(1) == 2);
+    moved = f;
+    REQUIRE(ptr.use_count() == 3);
+    f.reset();
+    moved.reset();
+    REQUIRE(ptr.use_count() == 1);
+  }
 }
@@ -15,6 +15,11 @@
  */
 #include "poly.hpp"
 #include <catch2/catch_all.hpp>
+#include <atomic>
+#include <memory_resource>
+#include <thread>
+#include <utility>
+#include <vector>
 
 POLY_METHOD(method);
 POLY_METHOD(method2);
@@ -28,6 +33,13 @@ using OBJ =
                  POLY_METHODS(int(method), int(method2), int(method2, int),
                               int(method2, int, float),
                               int(method2, int, double), void(method2, float))>;
+using INLINE_OBJ =
+    poly::Struct<poly::sbo_storage<32>,
+                 POLY_PROPERTIES(property(int), property2(float)),
+                 POLY_METHODS(int(method), int(method2), int(method2, int),
+                              int(method2, int, float),
+                              int(method2, int, double), void(method2, float)),
+                 poly::inline_vtable>;
 
 using Interface =
     poly::InterfaceRef<POLY_PROPERTIES(property(int), property2(float)),
@@ -82,7 +94,8 @@ void set(property, S2& s, const int& i) { *(s.p) = i; }
 float get(property2, const S2& s) { return *(s.f); }
 
 void set(property2, S2& s, const float& f) { *(s.f) = f + 1; }
-TEMPLATE_TEST_CASE("generic interface test", "[interface]", OBJ) {
+TEMPLATE_TEST_CASE("generic interface test", "[interface]", OBJ,
+                   INLINE_OBJ) {
   using If = TestType;
   S1 s1{79, 9.0f, {}};
   int i = {77};
@@ -148,6 +161,15 @@ TEMPLATE_TEST_CASE("generic interface test", "[interface]", OBJ) {
       REQUIRE(sub_interface.method2(41) == 42);
     }
   }
+  SECTION("Interface from Interface") {
+    Interface sub_interface{object};
+    Interface2 sub_interface2{sub_interface};
+    REQUIRE(sub_interface2.template call<method>() == 42);
+    REQUIRE(sub_interface2.template call<method2>(41) == 42);
+    REQUIRE(sub_interface2.template set<property>(22));
+    REQUIRE(sub_interface2.template get<property>() == 22);
+    REQUIRE(sub_interface.template get<property>() == 22);
+  }
   SECTION("Interface S1 property") {
     SECTION("same order of properties") {
       Interface sub_interface{object};
@@ -284,3 +306,319 @@ TEMPLATE_TEST_CASE("generic interface test", "[interface]", OBJ) {
     REQUIRE(object.property == 5);
   }
 }
+
+using FlatInterface =
+    poly::FlatInterfaceRef<POLY_PROPERTIES(property2(float), property(int)),
+                           POLY_METHODS(int(method2), int(method),
+                                        int(method2, int))>;
+using FlatInterface2 =
+    poly::FlatInterfaceRef<POLY_PROPERTIES(property(int)),
+                           POLY_METHODS(int(method2, int))>;
+using OwningFlatInterface =
+    poly::FlatInterface<poly::sbo_storage<32>,
+                        POLY_PROPERTIES(property2(float)),
+                        POLY_METHODS(int(method), int(method2))>;
+
+namespace {
+  template<std::size_t N>
+  struct Numbered {};
+
+  template<std::size_t N>
+  int extend(method2, Numbered<N>&, int i) {
+    return i + static_cast<int>(N);
+  }
+  template<std::size_t N>
+  int extend(method, Numbered<N>&) {
+    return 0;
+  }
+
+  /// converts Structs holding Numbered<Ns>... to a flat Interface. Every Ns
+  /// is a separate source table.
+  template<std::size_t... Ns>
+  int sum_numbered(std::index_sequence<Ns...>) {
+    using Numbers =
+        poly::Struct<poly::local_storage<8>, poly::type_list<>,
+                     POLY_METHODS(int(method), int(method2, int))>;
+    using Flat = poly::FlatInterfaceRef<poly::type_list<>,
+                                        POLY_METHODS(int(method2, int))>;
+    Numbers numbers[] = {Numbers{Numbered<Ns>{}}...};
+    int sum = 0;
+    for (Numbers& n : numbers)
+      sum += Flat{n}.method2(0);
+    return sum;
+  }
+} // namespace
+
+TEST_CASE("flat interface test", "[interface]") {
+  STATIC_REQUIRE(sizeof(FlatInterface) == 2 * sizeof(void*));
+  STATIC_REQUIRE(sizeof(FlatInterface2) == 2 * sizeof(void*));
+  S1 s1{79, 9.0f, {}};
+  int i = {77};
+  float f = 10.0f;
+  S2 s2{&i, &f};
+  OBJ object(s1);
+  SECTION("from Struct") {
+    FlatInterface flat{object};
+    REQUIRE(flat.method() == 42);
+    REQUIRE(flat.method2() == 54);
+    REQUIRE(flat.method2(41) == 42);
+    REQUIRE(flat.template get<property>() == 79);
+    REQUIRE(flat.template set<property>(22));
+    REQUIRE(flat.template get<property>() == 22);
+    REQUIRE(flat.template get<property2>() == 9.0f);
+    REQUIRE_FALSE(flat.template set<property2>(100.1f));
+
+    object = s2;
+    FlatInterface flat2{object};
+    REQUIRE(flat2.method() == 43);
+    REQUIRE(flat2.method2(41) == 43);
+    REQUIRE(flat2.template set<property2>(15.0f));
+    REQUIRE(f == 16.0f);
+  }
+  SECTION("from FlatInterface") {
+    FlatInterface flat{object};
+    FlatInterface2 sub{flat};
+    REQUIRE(sub.method2(41) == 42);
+    REQUIRE(sub.template get<property>() == 79);
+    OBJ object2{s2};
+    sub = FlatInterface2{object2};
+    REQUIRE(sub.method2(41) == 43);
+  }
+  SECTION("from T") {
+    FlatInterface flat{s1};
+    REQUIRE(flat.method() == 42);
+    REQUIRE(flat.method2(1) == 2);
+    REQUIRE(flat.template set<property>(3));
+    REQUIRE(s1.property == 3);
+
+    OwningFlatInterface owning{s2};
+    REQUIRE(owning.method() == 43);
+    REQUIRE(owning.method2() == 53);
+    REQUIRE(owning.template get<property2>() == 10.0f);
+    owning = OwningFlatInterface{s1};
+    REQUIRE(owning.method() == 42);
+  }
+  SECTION("tables are shared") {
+    FlatInterface flat{object};
+    FlatInterface flat2{object};
+    FlatInterface2 sub{flat};
+    FlatInterface2 sub2{flat2};
+    REQUIRE(sub2.method2(1) == 2);
+    REQUIRE(sub.method2(1) == sub2.method2(1));
+  }
+  SECTION("concurrent conversions") {
+    OBJ object2{s2};
+    std::vector<std::thread> threads;
+    std::atomic<int> sum{0};
+    for (int t = 0; t != 4; ++t) {
+      threads.emplace_back([&] {
+        for (int n = 0; n != 100; ++n) {
+          FlatInterface2 sub{n % 2 ? object : object2};
+          sum += sub.method2(0);
+        }
+      });
+    }
+    for (auto& t : threads)
+      t.join();
+    REQUIRE(sum == 4 * 50 * (1 + 2));
+  }
+  SECTION("more source tables than POLY_MAX_FLAT_TABLE_COUNT") {
+    constexpr std::size_t n = 2 * poly::config::max_flat_table_count + 10;
+    const int expected = static_cast<int>(n * (n - 1) / 2);
+    REQUIRE(sum_numbered(std::make_index_sequence<n>{}) == expected);
+    // the second round finds the tables built by the first one
+    REQUIRE(sum_numbered(std::make_index_sequence<n>{}) == expected);
+  }
+}
+
+TEST_CASE("struct vtable policies", "[interface]") {
+  using Small = POLY_METHODS(int(method), int(method2));
+  using Large = POLY_METHODS(int(method), int(method2), int(method2, int),
+                             int(method2, int, float));
+  using Props = POLY_PROPERTIES(property(int));
+  STATIC_REQUIRE(
+      std::is_same_v<poly::Reference<Props, Small, poly::auto_vtable<>>,
+                     poly::Reference<Props, Small, poly::inline_vtable>>);
+  STATIC_REQUIRE(
+      std::is_same_v<poly::Reference<Props, Large, poly::auto_vtable<>>,
+                     poly::Reference<Props, Large, poly::pointer_vtable>>);
+  STATIC_REQUIRE(
+      std::is_same_v<poly::Reference<Props, Large, poly::auto_vtable<4>>,
+                     poly::Reference<Props, Large, poly::inline_vtable>>);
+  // object and table pointer, and two inline method entries
+  STATIC_REQUIRE(sizeof(poly::Reference<Props, Small, poly::inline_vtable>) ==
+                 2 * sizeof(void*) +
+                     2 * sizeof(poly::detail::table_function<void()>));
+
+  S1 s1{79, 9.0f, {}};
+  int i = {77};
+  float f = 10.0f;
+  S2 s2{&i, &f};
+  INLINE_OBJ inline_obj{s1};
+  OBJ obj{inline_obj};
+  REQUIRE(obj.method() == 42);
+  inline_obj = OBJ{s2};
+  REQUIRE(inline_obj.method() == 43);
+  REQUIRE(inline_obj.method2(1) == 3);
+  REQUIRE(inline_obj.template get<property>() == 5);
+  poly::Reference<Props, Small, poly::inline_vtable> ref{s1};
+  REQUIRE(ref.method() == 42);
+  REQUIRE(ref.template get<property>() == 79);
+}
+
+namespace {
+  struct NoThrowProperty {
+    int value;
+  };
+  int get(property, const NoThrowProperty& t) noexcept { return t.value; }
+  void set(property, NoThrowProperty& t, const int& value) noexcept {
+    t.value = value;
+  }
+} // namespace
+
+TEST_CASE("noexcept settable property", "[interface]") {
+  NoThrowProperty t{1};
+  poly::Reference<POLY_PROPERTIES(property(int) noexcept), poly::type_list<>>
+      ref(t);
+  STATIC_REQUIRE(noexcept(ref.set<property>(2)));
+  REQUIRE(ref.set<property>(2));
+  REQUIRE(ref.get<property>() == 2);
+  REQUIRE(t.value == 2);
+}
+
+TEST_CASE("hot and cold methods", "[interface]") {
+  using Props = POLY_PROPERTIES(property(int), property2(float));
+  using Marked = poly::Reference<
+      Props, POLY_METHODS(poly::cold<int(method)>, int(method2),
+                          poly::hot<int(method2, int)>)>;
+  using Arranged = poly::Reference<
+      Props, POLY_METHODS(int(method2, int), int(method2), int(method))>;
+  STATIC_REQUIRE(std::is_same_v<Marked, Arranged>);
+  STATIC_REQUIRE(std::is_same_v<
+                 poly::detail::arrange_methods_t<poly::type_list<>>,
+                 poly::type_list<>>);
+  STATIC_REQUIRE(
+      std::is_same_v<poly::detail::arrange_methods_t<
+                         poly::type_list<poly::cold<int>, char, poly::hot<float>,
+                                         double, poly::hot<long>>>,
+                     poly::type_list<float, long, char, double, int>>);
+
+  using table = poly::detail::struct_table<
+      Props, POLY_METHODS(int(method2, int), int(method2), int(method))>;
+  REQUIRE(table::method_offset(poly::traits::Id<int(method2, int)>{}) <
+          table::method_offset(poly::traits::Id<int(method)>{}));
+
+  S1 s1{79, 9.0f, {}};
+  Marked ref{s1};
+  REQUIRE(ref.method() == 42);
+  REQUIRE(ref.method2(41) == 42);
+  Interface iref{ref};
+  REQUIRE(iref.method() == 42);
+  REQUIRE(iref.method2(41) == 42);
+}
+
+TEST_CASE("struct with allocator", "[interface]") {
+  using Alloc = std::pmr::polymorphic_allocator<std::byte>;
+  using PmrObj = poly::Struct<
+      poly::sbo_storage<32, alignof(std::max_align_t), Alloc>,
+      POLY_PROPERTIES(property(int), property2(float)),
+      POLY_METHODS(int(method), int(method2), int(method2, int))>;
+  alignas(std::max_align_t) std::byte buffer[512];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                            std::pmr::null_memory_resource());
+  const auto in_arena = [&](const void* p) {
+    return static_cast<const std::byte*>(p) >= buffer and
+           static_cast<const std::byte*>(p) < buffer + sizeof(buffer);
+  };
+
+  PmrObj obj(std::allocator_arg, Alloc(&arena), S1{79, 9.0f, {}});
+  REQUIRE(in_arena(obj.target<S1>()));
+  REQUIRE(obj.method() == 42);
+  REQUIRE(obj.get<property>() == 79);
+
+  PmrObj obj2(std::allocator_arg, Alloc(&arena), poly::traits::Id<S1>{},
+              S1{80, 9.0f, {}});
+  REQUIRE(in_arena(obj2.target<S1>()));
+  REQUIRE(obj2.get<property>() == 80);
+}
+
+TEST_CASE("struct with shared storage", "[interface]") {
+  using Props = POLY_PROPERTIES(property(int), property2(float));
+  using Methods = POLY_METHODS(int(method), int(method2), int(method2, int));
+  using Shared = poly::Struct<poly::shared_storage, Props, Methods>;
+  using SharedInterface =
+      poly::Interface<poly::shared_storage, Props,
+                      POLY_METHODS(int(method), int(method2, int))>;
+
+  Shared obj{S1{79, 9.0f, {}}};
+  const S1* addr = obj.target<S1>();
+  Shared copy{obj};
+  REQUIRE(copy.target<S1>() == addr);
+  REQUIRE(copy.method() == 42);
+
+  SharedInterface iface{copy};
+  REQUIRE(iface.method() == 42);
+  REQUIRE(iface.get<property>() == 79);
+  // the object is shared, setting the property through one copy is visible
+  // in all of them
+  REQUIRE(iface.set<property>(80));
+  REQUIRE(obj.get<property>() == 80);
+
+  poly::Reference<Props, Methods> ref{obj};
+  REQUIRE(ref.target<S1>() == addr);
+  REQUIRE(ref.method() == 42);
+}
+
+namespace {
+struct Config {
+  int threshold;
+};
+int extend(method, const Config& c) { return c.threshold; }
+int extend(method2, const Config& c) { return c.threshold + 1; }
+void extend(method2, Config& c, int t) { c.threshold = t; }
+
+int get(property, const Config& c) { return c.threshold; }
+void set(property, Config& c, const int& t) { c.threshold = t; }
+} // namespace
+
+TEST_CASE("struct with cow storage", "[interface]") {
+  using Props = POLY_PROPERTIES(property(int));
+  using Methods =
+      POLY_METHODS(int(method) const, int(method2) const, void(method2, int));
+  using Cow = poly::Struct<poly::cow_storage, Props, Methods>;
+  using CowInterface = poly::Interface<poly::cow_storage, Props,
+                                       POLY_METHODS(int(method2) const,
+                                                    void(method2, int))>;
+
+  Cow obj{Config{10}};
+  const Config* addr = std::as_const(obj).target<Config>();
+  Cow copy{obj};
+
+  // const methods and properties do not copy the object, even when called on
+  // a non const Struct
+  REQUIRE(copy.method() == 10);
+  REQUIRE(copy.method2() == 11);
+  REQUIRE(copy.call_as<method2, Config>() == 11);
+  REQUIRE(copy.get<property>() == 10);
+  REQUIRE(std::as_const(copy).target<Config>() == addr);
+
+  // non const methods copy the object first
+  copy.method2(20);
+  REQUIRE(copy.method() == 20);
+  REQUIRE(obj.method() == 10);
+  REQUIRE(std::as_const(copy).target<Config>() != addr);
+  REQUIRE(std::as_const(obj).target<Config>() == addr);
+
+  // the only remaining owner modifies in place
+  obj.method2(30);
+  REQUIRE(obj.method() == 30);
+  REQUIRE(std::as_const(obj).target<Config>() == addr);
+
+  CowInterface iface{obj};
+  REQUIRE(iface.method2() == 31);
+  REQUIRE(iface.get<property>() == 30);
+  REQUIRE(std::as_const(obj).target<Config>() == addr);
+  REQUIRE(iface.set<property>(40));
+  REQUIRE(iface.method2() == 41);
+  REQUIRE(obj.method() == 30);
+}
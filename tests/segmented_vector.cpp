@@ -0,0 +1,145 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "poly.hpp"
+#include <catch2/catch_all.hpp>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+POLY_METHOD(step);
+POLY_METHOD(energy);
+POLY_METHOD(take);
+POLY_PROPERTY(mass);
+
+namespace {
+  struct Ball {
+    float mass;
+    float v;
+  };
+  struct Box {
+    float mass;
+    float v;
+    std::string label;
+  };
+
+  void extend(step, Ball& b, float dt) { b.v += dt; }
+  void extend(step, Box& b, float dt) { b.v += 2 * dt; }
+  float extend(energy, const Ball& b) { return b.mass * b.v; }
+  float extend(energy, const Box& b) { return b.mass * b.v * 2; }
+  void extend(take, Ball& b, std::unique_ptr<float> f) { b.v = *f; }
+  void extend(take, Box& b, std::unique_ptr<float> f) { b.v = *f; }
+  float get(mass, const Ball& b) { return b.mass; }
+  float get(mass, const Box& b) { return b.mass; }
+  void set(mass, Ball& b, const float& m) { b.mass = m; }
+  void set(mass, Box& b, const float& m) { b.mass = m; }
+} // namespace
+
+using Props = POLY_PROPERTIES(mass(float));
+using Methods = POLY_METHODS(void(step, float), float(energy) const,
+                             void(take, std::unique_ptr<float>));
+using Vector = poly::segmented_vector<Props, Methods>;
+
+TEST_CASE("segmented_vector", "[segmented_vector]") {
+  Vector vec;
+  REQUIRE(vec.empty());
+  for (int i = 0; i < 10; ++i) {
+    vec.emplace_back<Ball>(Ball{1.0f, 0.0f});
+    vec.push_back(Box{2.0f, 0.0f, "box"});
+  }
+  REQUIRE(vec.size() == 20);
+  REQUIRE(vec.segment_count() == 2);
+  REQUIRE(vec.count<Ball>() == 10);
+  REQUIRE(vec.count<Box>() == 10);
+  REQUIRE(vec.count<int>() == 0);
+  REQUIRE(vec.data<int>() == nullptr);
+  REQUIRE(vec.data<Box>()[9].label == "box");
+
+  SECTION("call") {
+    vec.call<step>(1.0f);
+    REQUIRE(vec.data<Ball>()[3].v == 1.0f);
+    REQUIRE(vec.data<Box>()[3].v == 2.0f);
+    float total = 0;
+    for (auto ref : vec)
+      total += ref.call<energy>();
+    REQUIRE(total == 10 * 1.0f + 10 * 8.0f);
+  }
+  SECTION("move only arguments") {
+    vec[3].call<take>(std::make_unique<float>(3.0f));
+    REQUIRE(vec.data<Ball>()[3].v == 3.0f);
+  }
+  SECTION("references") {
+    REQUIRE(vec[0].get<mass>() == 1.0f);
+    REQUIRE(vec[10].get<mass>() == 2.0f);
+    vec[10].set<mass>(5.0f);
+    REQUIRE(vec.data<Box>()[0].mass == 5.0f);
+    std::size_t n = 0;
+    for (auto ref : vec) {
+      ref.call<step>(1.0f);
+      ++n;
+    }
+    REQUIRE(n == 20);
+    REQUIRE(vec.data<Box>()[9].v == 2.0f);
+  }
+  SECTION("get_all") {
+    vec.push_back(Ball{3.0f, 0.0f});
+    std::vector<float> masses(vec.size());
+    REQUIRE(vec.get_all<mass>(masses.data()) == masses.data() + 21);
+    REQUIRE(masses[0] == 1.0f);
+    REQUIRE(masses[10] == 3.0f);
+    REQUIRE(masses[11] == 2.0f);
+    REQUIRE(masses[20] == 2.0f);
+  }
+  SECTION("inserting an element of the same vector") {
+    while (vec.count<Box>() != 16)
+      vec.push_back(Box{2.0f, 0.0f, "a label too long for small strings"});
+    // the segment is full, the argument lives in the buffer being replaced
+    vec.push_back(vec.data<Box>()[15]);
+    REQUIRE(vec.count<Box>() == 17);
+    REQUIRE(vec.data<Box>()[16].label == "a label too long for small strings");
+    vec.emplace_back<Box>(vec.data<Box>()[0]);
+    REQUIRE(vec.data<Box>()[17].label == "box");
+  }
+  SECTION("clear and move") {
+    vec.clear();
+    REQUIRE(vec.empty());
+    REQUIRE(vec.begin() == vec.end());
+    vec.push_back(Box{1.0f, 1.0f, "b"});
+    REQUIRE(vec.begin() != vec.end());
+    REQUIRE((*vec.begin()).call<energy>() == 2.0f);
+    Vector other = std::move(vec);
+    REQUIRE(other.size() == 1);
+    REQUIRE(vec.empty());
+    REQUIRE(vec.segment_count() == 0);
+  }
+  SECTION("const") {
+    const Vector& cvec = vec;
+    cvec.call<energy>();
+    REQUIRE(cvec.data<Ball>()[0].mass == 1.0f);
+    STATIC_REQUIRE(std::forward_iterator<Vector::const_iterator>);
+    STATIC_REQUIRE(std::forward_iterator<Vector::iterator>);
+    Vector::const_iterator it = vec.begin();
+    REQUIRE(it == cvec.begin());
+    std::size_t n = 0;
+    float total = 0;
+    for (const auto& ref : cvec) {
+      total += ref.call<energy>();
+      ++n;
+    }
+    REQUIRE(n == 20);
+    REQUIRE(total == 0.0f);
+  }
+}
@@ -14,6 +14,7 @@
  *  limitations under the License.
  */
 #include "poly.hpp"
+#include "poly/function.hpp"
 #include <iostream>
 
 POLY_METHOD(method);
@@ -53,6 +54,19 @@ struct property17 {};
 struct property18 {};
 struct property19 {};
 int main() {
+  std::cout << "struct table size for 9 methods and 9 properties: "
+            << sizeof(poly::detail::struct_table<
+                      poly::type_list<property1(int), property2(int),
+                                      property3(int), property4(int),
+                                      property5(int), property6(int),
+                                      property7(int), property8(int),
+                                      property9(int)>,
+                      poly::type_list<void(method), void(method2),
+                                      void(method3), void(method4),
+                                      void(method5), void(method6),
+                                      void(method7), void(method8),
+                                      void(method9)>>)
+            << std::endl;
   std::cout << "different poly::Reference sizes in bytes" << std::endl;
 
   std::cout << "base size: "
@@ -399,4 +413,56 @@ int main() {
                                                          void(m8),
                                                          void(m9)>>)
             << std::endl;
+
+  std::cout << "different poly::FlatInterfaceRef sizes in bytes"
+            << std::endl;
+
+  std::cout << "base size: "
+            << sizeof(poly::FlatInterfaceRef<poly::type_list<>,
+                                             poly::type_list<>>)
+            << std::endl;
+  std::cout << "9 named methods, 9 named properties: "
+            << sizeof(poly::FlatInterfaceRef<poly::type_list<property1(int),
+                                                             property2(int),
+                                                             property3(int),
+                                                             property4(int),
+                                                             property5(int),
+                                                             property6(int),
+                                                             property7(int),
+                                                             property8(int),
+                                                             property9(int)>,
+                                             poly::type_list<void(method),
+                                                             void(method2),
+                                                             void(method3),
+                                                             void(method4),
+                                                             void(method5),
+                                                             void(method6),
+                                                             void(method7),
+                                                             void(method8),
+                                                             void(method9)>>)
+            << std::endl;
+
+  std::cout << "different poly::any_function sizes in bytes, the storage is a "
+               "poly::local_storage<32>"
+            << std::endl;
+  std::cout << "storage size: " << sizeof(poly::local_storage<32>)
+            << std::endl;
+  std::cout << "1 signature: "
+            << sizeof(poly::any_function<poly::local_storage<32>, void(int)>)
+            << std::endl;
+  std::cout << "3 signatures: "
+            << sizeof(poly::any_function<poly::local_storage<32>, void(int),
+                                         void(float), void(double)>)
+            << std::endl;
+  std::cout << "6 signatures: "
+            << sizeof(poly::any_function<poly::local_storage<32>, void(int),
+                                         void(float), void(double), void(char),
+                                         void(long), void(short)>)
+            << std::endl;
+
+  std::cout << "poly::function<void(int), poly::ref_storage>: "
+            << sizeof(poly::function<void(int), poly::ref_storage>)
+            << std::endl;
+  std::cout << "poly::function_ref<void(int)>: "
+            << sizeof(poly::function_ref<void(int)>) << std::endl;
 }
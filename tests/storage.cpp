@@ -16,6 +16,17 @@
 #include "poly/storage.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  bool is_aligned(const void* p, std::size_t align) {
+    return reinterpret_cast<std::uintptr_t>(p) % align == 0;
+  }
+} // namespace
 
 static_assert(poly::is_storage_v<poly::local_storage<32, 8>>);
 static_assert(poly::is_storage_v<poly::local_storage<64, 4>>);
@@ -52,6 +63,35 @@ static_assert(
 static_assert(std::is_move_constructible_v<poly::move_only_sbo_storage<32, 8>>);
 static_assert(std::is_move_assignable_v<poly::move_only_sbo_storage<32, 8>>);
 
+using pmr_allocator = std::pmr::polymorphic_allocator<std::byte>;
+using pmr_sbo_storage = poly::sbo_storage<32, 8, pmr_allocator>;
+using pmr_heap_storage = poly::allocator_heap_storage<pmr_allocator>;
+static_assert(poly::is_storage_v<pmr_sbo_storage>);
+static_assert(poly::is_storage_v<pmr_heap_storage>);
+static_assert(
+    poly::is_storage_v<poly::move_only_sbo_storage<32, 8, pmr_allocator>>);
+static_assert(poly::is_storage_v<
+              poly::move_only_allocator_heap_storage<pmr_allocator>>);
+static_assert(poly::is_storage_v<poly::arena_storage<32>>);
+static_assert(poly::is_storage_v<poly::move_only_arena_storage<32>>);
+static_assert(poly::is_storage_v<poly::shared_storage>);
+static_assert(poly::is_storage_v<poly::atomic_shared_storage>);
+static_assert(std::is_nothrow_copy_constructible_v<poly::shared_storage>);
+static_assert(poly::is_storage_v<poly::cow_storage>);
+static_assert(poly::is_storage_v<poly::cached_sbo_storage<32, 8>>);
+static_assert(poly::is_storage_v<poly::move_only_cached_sbo_storage<32, 8>>);
+static_assert(
+    not std::is_copy_constructible_v<poly::move_only_cached_sbo_storage<32, 8>>);
+static_assert(sizeof(poly::cached_sbo_storage<32, 8>) ==
+              sizeof(poly::sbo_storage<32, 8>) + sizeof(void*));
+static_assert(poly::is_storage_v<poly::atomic_cow_storage>);
+static_assert(poly::is_trivially_relocatable_v<int>);
+static_assert(not poly::is_trivially_relocatable_v<std::vector<int>>);
+// stateless allocators take up no space
+static_assert(sizeof(poly::sbo_storage<32, 8>) ==
+              sizeof(poly::sbo_storage<32, 8, std::allocator<std::byte>>));
+static_assert(sizeof(poly::heap_storage) == sizeof(void*));
+
 template<size_t Size, size_t Align>
 class Tracker {
 public:
@@ -110,7 +150,10 @@ TEMPLATE_TEST_CASE(
     "storage ctor", "[storage]", (poly::local_storage<32, 8>),
     (poly::move_only_local_storage<32, 8>), (poly::sbo_storage<32, 8>),
     (poly::variant_storage<Tracker<64, 16>, Tracker<64, 8>, Tracker<8, 16>>),
-    poly::heap_storage, poly::move_only_heap_storage) {
+    poly::heap_storage, poly::move_only_heap_storage, poly::shared_storage,
+    poly::atomic_shared_storage, poly::cow_storage, poly::atomic_cow_storage,
+    (poly::cached_sbo_storage<32, 8>),
+    (poly::move_only_cached_sbo_storage<32, 8>)) {
 
   using Storage = TestType;
   // using Object = poly::at_t<TestType, 1>;
@@ -130,6 +173,8 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<8, 8>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<64, 16>>),
     (poly::type_list<
         poly::variant_storage<Tracker<64, 16>, Tracker<64, 8>, Tracker<8, 16>>,
         Tracker<64, 16>>),
@@ -142,7 +187,11 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::heap_storage, Tracker<8, 8>>),
     (poly::type_list<poly::heap_storage, Tracker<8, 16>>),
     (poly::type_list<poly::heap_storage, Tracker<64, 8>>),
-    (poly::type_list<poly::heap_storage, Tracker<64, 16>>)) {
+    (poly::type_list<poly::heap_storage, Tracker<64, 16>>),
+    (poly::type_list<pmr_sbo_storage, Tracker<8, 8>>),
+    (poly::type_list<pmr_sbo_storage, Tracker<64, 16>>),
+    (poly::type_list<pmr_heap_storage, Tracker<64, 16>>),
+    (poly::type_list<poly::arena_storage<32, 8>, Tracker<64, 16>>)) {
 
   using Storage = poly::at_t<TestType, 0>;
   using Object = poly::at_t<TestType, 1>;
@@ -244,6 +293,8 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<8, 8>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<64, 16>>),
     (poly::type_list<
         poly::variant_storage<Tracker<64, 16>, Tracker<64, 8>, Tracker<8, 16>>,
         Tracker<64, 16>>),
@@ -257,6 +308,10 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<8, 8>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<64, 16>>),
     (poly::type_list<poly::heap_storage, Tracker<8, 8>>),
     (poly::type_list<poly::heap_storage, Tracker<8, 16>>),
     (poly::type_list<poly::heap_storage, Tracker<64, 8>>),
@@ -264,7 +319,12 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::move_only_heap_storage, Tracker<8, 8>>),
     (poly::type_list<poly::move_only_heap_storage, Tracker<8, 16>>),
     (poly::type_list<poly::move_only_heap_storage, Tracker<64, 8>>),
-    (poly::type_list<poly::move_only_heap_storage, Tracker<64, 16>>)) {
+    (poly::type_list<poly::move_only_heap_storage, Tracker<64, 16>>),
+    (poly::type_list<pmr_sbo_storage, Tracker<8, 8>>),
+    (poly::type_list<pmr_sbo_storage, Tracker<64, 16>>),
+    (poly::type_list<pmr_heap_storage, Tracker<64, 16>>),
+    (poly::type_list<poly::arena_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::move_only_arena_storage<32, 8>, Tracker<64, 16>>)) {
 
   using Storage = poly::at_t<TestType, 0>;
   using Object = poly::at_t<TestType, 1>;
@@ -361,10 +421,16 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<8, 8>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<64, 16>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<8, 8>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<8, 8>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<64, 16>>),
     (poly::type_list<
         poly::variant_storage<Tracker<64, 16>, Tracker<64, 8>, Tracker<8, 16>>,
         Tracker<64, 16>>),
@@ -402,6 +468,8 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<8, 8>>),
+    (poly::type_list<poly::cached_sbo_storage<32, 8>, Tracker<64, 16>>),
     (poly::type_list<
         poly::variant_storage<Tracker<64, 16>, Tracker<64, 8>, Tracker<8, 16>>,
         Tracker<64, 16>>),
@@ -415,6 +483,10 @@ TEMPLATE_TEST_CASE(
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<8, 16>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 8>>),
     (poly::type_list<poly::move_only_sbo_storage<32, 8>, Tracker<64, 16>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<8, 8>>),
+    (poly::type_list<poly::move_only_cached_sbo_storage<32, 8>,
+                     Tracker<64, 16>>),
     (poly::type_list<poly::heap_storage, Tracker<8, 8>>),
     (poly::type_list<poly::heap_storage, Tracker<8, 16>>),
     (poly::type_list<poly::heap_storage, Tracker<64, 8>>),
@@ -698,11 +770,19 @@ using F = poly::type_list<poly::sbo_storage<32, 4>, poly::sbo_storage<16, 8>,
 using A1 = poly::type_list<poly::heap_storage, poly::heap_storage,
                            Tracker<8, 8>, Tracker<16, 8>, Tracker<32, 8>,
                            Tracker<8, 16>, Tracker<32, 16>>;
+using A2 = poly::type_list<poly::cached_sbo_storage<32, 8>,
+                           poly::cached_sbo_storage<16, 8>, Tracker<8, 8>,
+                           Tracker<16, 8>, Tracker<32, 8>, Tracker<8, 16>,
+                           Tracker<32, 16>>;
+using A3 = poly::type_list<poly::cached_sbo_storage<16, 4>,
+                           poly::cached_sbo_storage<32, 8>, Tracker<8, 8>,
+                           Tracker<16, 8>, Tracker<32, 8>, Tracker<8, 16>,
+                           Tracker<32, 16>>;
 /// covers:
 /// - copy ctor for different sizes
 /// - copy assignment for different sizes
 TEMPLATE_TEST_CASE("copy sbo storage of different sizes", "[storage]", A, B, C,
-                   D, E, F, A1) {
+                   D, E, F, A1, A2, A3) {
 
   using Storage1 = poly::at_t<TestType, 0>;
   using Storage2 = poly::at_t<TestType, 1>;
@@ -926,11 +1006,15 @@ using L =
     poly::type_list<poly::move_only_heap_storage, poly::move_only_heap_storage,
                     Tracker<8, 8>, Tracker<16, 8>, Tracker<32, 8>,
                     Tracker<8, 16>, Tracker<32, 16>>;
+using L1 = poly::type_list<poly::move_only_cached_sbo_storage<16, 8>,
+                           poly::move_only_cached_sbo_storage<32, 8>,
+                           Tracker<8, 8>, Tracker<16, 8>, Tracker<32, 8>,
+                           Tracker<8, 16>, Tracker<32, 16>>;
 /// covers:
 /// - move ctor for different sizes
 /// - move assignment for different sizes
 TEMPLATE_TEST_CASE("move sbo storage of different sizes", "[storage]", A, B, C,
-                   D, E, F, G, H, I, J, K, L) {
+                   D, E, F, G, H, I, J, K, L, A2, A3, L1) {
 
   using Storage1 = poly::at_t<TestType, 0>;
   using Storage2 = poly::at_t<TestType, 1>;
@@ -1182,3 +1266,452 @@ TEMPLATE_TEST_CASE("ref_storage assignment", "[storage]", M1, M2, M3, M4, M5,
   REQUIRE(ref.template emplace<Object>(obj) == addr);
   REQUIRE(count == 3);
 }
+
+/// stateful allocator counting the number of live allocations. Allocators
+/// compare equal if they share the same counter.
+template<typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(int& c) : live(&c) {}
+  template<typename U>
+  counting_allocator(const counting_allocator<U>& other) : live(other.live) {}
+
+  T* allocate(std::size_t n) {
+    ++(*live);
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) {
+    --(*live);
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  template<typename U>
+  bool operator==(const counting_allocator<U>& other) const {
+    return live == other.live;
+  }
+  template<typename U>
+  bool operator!=(const counting_allocator<U>& other) const {
+    return live != other.live;
+  }
+
+  int* live;
+};
+
+TEMPLATE_TEST_CASE("storage with allocator", "[storage]",
+                   (poly::sbo_storage<32, 8, counting_allocator<std::byte>>),
+                   (poly::allocator_heap_storage<
+                       counting_allocator<std::byte>>)) {
+  using Storage = TestType;
+  using Object = Tracker<64, 8>;
+  int count = 0;
+  int live1 = 0;
+  int live2 = 0;
+  const counting_allocator<std::byte> alloc1(live1);
+  const counting_allocator<std::byte> alloc2(live2);
+  SECTION("emplace allocates with the allocator") {
+    {
+      Storage s(alloc1);
+      REQUIRE(s.get_allocator() == alloc1);
+      s.template emplace<Object>(count);
+      REQUIRE(count == 1);
+      REQUIRE(live1 == 1);
+    }
+    REQUIRE(count == 0);
+    REQUIRE(live1 == 0);
+  }
+  SECTION("copy uses the allocator of the source") {
+    {
+      Storage s1(alloc1);
+      s1.template emplace<Object>(count);
+      Storage s2(s1);
+      REQUIRE(count == 2);
+      REQUIRE(live1 == 2);
+      REQUIRE(s2.get_allocator() == alloc1);
+    }
+    REQUIRE(count == 0);
+    REQUIRE(live1 == 0);
+  }
+  SECTION("copy assignment keeps the allocator of the destination") {
+    {
+      Storage s1(alloc1);
+      Storage s2(alloc2);
+      s1.template emplace<Object>(count);
+      s2 = s1;
+      REQUIRE(count == 2);
+      REQUIRE(live1 == 1);
+      REQUIRE(live2 == 1);
+    }
+    REQUIRE(count == 0);
+    REQUIRE(live1 == 0);
+    REQUIRE(live2 == 0);
+  }
+  SECTION("move assignment with equal allocators steals the object") {
+    {
+      Storage s1(alloc1);
+      Storage s2(alloc1);
+      void* addr = s1.template emplace<Object>(count);
+      s2 = std::move(s1);
+      REQUIRE(count == 1);
+      REQUIRE(live1 == 1);
+      REQUIRE(s2.data() == addr);
+      REQUIRE(s1.data() == nullptr);
+    }
+    REQUIRE(count == 0);
+    REQUIRE(live1 == 0);
+  }
+  SECTION("move assignment with different allocators moves the object") {
+    {
+      Storage s1(alloc1);
+      Storage s2(alloc2);
+      s1.template emplace<Object>(count);
+      s2 = std::move(s1);
+      REQUIRE(count == 1);
+      REQUIRE(live1 == 0);
+      REQUIRE(live2 == 1);
+      REQUIRE(s1.data() == nullptr);
+      REQUIRE(s2.data() != nullptr);
+    }
+    REQUIRE(count == 0);
+    REQUIRE(live2 == 0);
+  }
+}
+
+TEST_CASE("storage with monotonic buffer resource", "[storage]") {
+  alignas(std::max_align_t) std::byte buffer[1024];
+  std::pmr::monotonic_buffer_resource arena(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  const pmr_allocator alloc(&arena);
+  const auto in_arena = [&](const void* p) {
+    return static_cast<const std::byte*>(p) >= buffer and
+           static_cast<const std::byte*>(p) < buffer + sizeof(buffer);
+  };
+  int count = 0;
+  {
+    pmr_sbo_storage s1(alloc);
+    REQUIRE(in_arena(s1.emplace<Tracker<64, 16>>(count)));
+    REQUIRE(not in_arena(s1.emplace<Tracker<8, 8>>(count)));
+    REQUIRE(count == 1);
+
+    pmr_heap_storage s2(alloc);
+    REQUIRE(in_arena(s2.emplace<Tracker<8, 8>>(count)));
+    REQUIRE(count == 2);
+
+    // the copy allocates with the default resource, as specified by
+    // polymorphic_allocator::select_on_container_copy_construction
+    pmr_heap_storage s3(s2);
+    REQUIRE(not in_arena(s3.data()));
+    REQUIRE(count == 3);
+  }
+  REQUIRE(count == 0);
+}
+
+TEST_CASE("arena_storage", "[storage]") {
+  alignas(std::max_align_t) std::byte buffer[256];
+  poly::arena arena(buffer, sizeof(buffer), 1024);
+  const auto in_buffer = [&](const void* p) {
+    return static_cast<const std::byte*>(p) >= buffer and
+           static_cast<const std::byte*>(p) < buffer + sizeof(buffer);
+  };
+  int count = 0;
+  SECTION("objects not fitting the buffer are allocated from the arena") {
+    {
+      poly::arena_storage<32, 8> s(arena);
+      REQUIRE(s.get_allocator().resource() == &arena);
+      void* first = s.emplace<Tracker<64, 16>>(count);
+      REQUIRE(in_buffer(first));
+      REQUIRE(is_aligned(first, 16));
+      // destroying the object does not free its memory
+      void* second = s.emplace<Tracker<64, 16>>(count);
+      REQUIRE(second != first);
+      REQUIRE(count == 1);
+      poly::arena_storage<32, 8> copy(s);
+      REQUIRE(in_buffer(copy.data()));
+      REQUIRE(count == 2);
+    }
+    REQUIRE(count == 0);
+  }
+  SECTION("the arena grows once the buffer is exhausted") {
+    {
+      std::vector<poly::arena_storage<32, 8>> objects;
+      objects.reserve(16);
+      for (int i = 0; i != 16; ++i) {
+        objects.emplace_back(arena);
+        REQUIRE(objects.back().emplace<Tracker<128, 16>>(count) != nullptr);
+      }
+      REQUIRE(count == 16);
+      REQUIRE(in_buffer(objects.front().data()));
+      REQUIRE(not in_buffer(objects.back().data()));
+    }
+    REQUIRE(count == 0);
+    arena.release();
+    poly::arena_storage<32, 8> s(arena);
+    REQUIRE(in_buffer(s.emplace<Tracker<64, 16>>(count)));
+  }
+  SECTION("default constructed storages use the arena of the thread") {
+    poly::arena_storage<32, 8> s;
+    REQUIRE(s.get_allocator().resource() == &poly::arena::local());
+    REQUIRE(s.emplace<Tracker<64, 16>>(count) != nullptr);
+  }
+}
+
+TEMPLATE_TEST_CASE("shared_storage", "[storage]", poly::shared_storage,
+                   poly::atomic_shared_storage) {
+  using Storage = TestType;
+  using Object = Tracker<64, 16>;
+  int count = 0;
+  SECTION("copies share the object") {
+    {
+      Storage s1;
+      void* addr = s1.template emplace<Object>(count);
+      REQUIRE(is_aligned(addr, 16));
+      REQUIRE(s1.use_count() == 1);
+      Storage s2(s1);
+      Storage s3;
+      s3 = s2;
+      REQUIRE(count == 1);
+      REQUIRE(s1.use_count() == 3);
+      REQUIRE(s2.data() == addr);
+      REQUIRE(s3.data() == addr);
+      s3 = s3;
+      REQUIRE(s1.use_count() == 3);
+      s1 = Storage{};
+      REQUIRE(s1.data() == nullptr);
+      REQUIRE(s1.use_count() == 0);
+      REQUIRE(s2.use_count() == 2);
+      REQUIRE(count == 1);
+    }
+    REQUIRE(count == 0);
+  }
+  SECTION("move transfers ownership") {
+    {
+      Storage s1;
+      void* addr = s1.template emplace<Object>(count);
+      Storage s2(std::move(s1));
+      REQUIRE(s1.data() == nullptr);
+      REQUIRE(s2.data() == addr);
+      REQUIRE(s2.use_count() == 1);
+      Storage s3;
+      s3.template emplace<Object>(count);
+      REQUIRE(count == 2);
+      s3 = std::move(s2);
+      REQUIRE(count == 1);
+      REQUIRE(s3.data() == addr);
+    }
+    REQUIRE(count == 0);
+  }
+  SECTION("emplace releases the shared object") {
+    Storage s1;
+    s1.template emplace<Object>(count);
+    Storage s2(s1);
+    s1.template emplace<Object>(count);
+    REQUIRE(count == 2);
+    REQUIRE(s1.data() != s2.data());
+    REQUIRE(s1.use_count() == 1);
+    REQUIRE(s2.use_count() == 1);
+  }
+  SECTION("ref_storage refers to the shared object") {
+    Storage s;
+    void* addr = s.template emplace<Object>(count);
+    poly::ref_storage ref(s);
+    REQUIRE(ref.data() == addr);
+    REQUIRE(s.use_count() == 1);
+  }
+}
+
+namespace {
+/// counts calls of the move constructor and destructor. Marked trivially
+/// relocatable below, so storages must not call either of them when moved.
+struct Relocatable {
+  Relocatable(int& moves, int& destroyed)
+      : moves(&moves), destroyed(&destroyed) {}
+  Relocatable(Relocatable&& other)
+      : moves(other.moves), destroyed(other.destroyed) {
+    ++*moves;
+  }
+  Relocatable(const Relocatable& other) = default;
+  ~Relocatable() { ++*destroyed; }
+  int* moves;
+  int* destroyed;
+};
+} // namespace
+
+template<>
+struct poly::is_trivially_relocatable<Relocatable> : std::true_type {};
+
+/// covers:
+///   - storages relocate trivially relocatable objects with memcpy
+TEMPLATE_TEST_CASE("storage relocation", "[storage]",
+                   (poly::local_storage<32, 8>),
+                   (poly::move_only_local_storage<32, 8>),
+                   (poly::sbo_storage<32, 8>),
+                   (poly::cached_sbo_storage<32, 8>),
+                   (poly::move_only_sbo_storage<32, 8>),
+                   (poly::variant_storage<int, Relocatable, double>)) {
+  using Storage = TestType;
+  int moves = 0;
+  int destroyed = 0;
+  {
+    Storage s1;
+    s1.template emplace<Relocatable>(moves, destroyed);
+    Storage s2(std::move(s1));
+    REQUIRE(s1.data() == nullptr);
+    REQUIRE(s2.data() != nullptr);
+    REQUIRE(static_cast<Relocatable*>(s2.data())->moves == &moves);
+    Storage s3;
+    s3 = std::move(s2);
+    REQUIRE(s2.data() == nullptr);
+    REQUIRE(static_cast<Relocatable*>(s3.data())->destroyed == &destroyed);
+    REQUIRE(moves == 0);
+    REQUIRE(destroyed == 0);
+  }
+  REQUIRE(destroyed == 1);
+}
+
+namespace {
+struct Trivial {
+  int values[4];
+};
+} // namespace
+
+/// covers:
+///   - trivially copyable objects are copied with memcpy, from the buffer and
+///     from the heap
+TEMPLATE_TEST_CASE("copy trivial objects", "[storage]",
+                   (poly::local_storage<32, 8>), (poly::sbo_storage<32, 8>),
+                   (poly::cached_sbo_storage<32, 8>),
+                   (poly::sbo_storage<8, 8>)) {
+  using Storage = TestType;
+  Storage s1;
+  s1.template emplace<Trivial>(Trivial{{1, 2, 3, 4}});
+  Storage s2(s1);
+  REQUIRE(s2.data() != s1.data());
+  const auto* t = static_cast<const Trivial*>(s2.data());
+  REQUIRE(t->values[0] == 1);
+  REQUIRE(t->values[3] == 4);
+
+  Storage s3;
+  s3.template emplace<int>(5);
+  s3 = s1;
+  t = static_cast<const Trivial*>(s3.data());
+  REQUIRE(t->values[1] == 2);
+  REQUIRE(t->values[2] == 3);
+
+  if constexpr (not std::is_same_v<Storage, poly::local_storage<32, 8>>) {
+    // copy from the heap of a small storage into a buffer
+    poly::sbo_storage<8, 8> small;
+    small.template emplace<Trivial>(Trivial{{5, 6, 7, 8}});
+    poly::sbo_storage<32, 8> large(small);
+    t = static_cast<const Trivial*>(large.data());
+    REQUIRE(static_cast<const void*>(t) != small.data());
+    REQUIRE(t->values[0] == 5);
+    REQUIRE(t->values[3] == 8);
+  }
+}
+
+namespace {
+template<std::size_t I>
+struct Indexed {
+  int value;
+};
+template<std::size_t... Is>
+poly::variant_storage<Indexed<Is>..., int, std::string>
+    many_types(std::index_sequence<Is...>);
+/// variant_storage with enough types to dispatch through tables
+using ManyTypes = decltype(many_types(std::make_index_sequence<30>{}));
+} // namespace
+
+/// covers:
+///   - every type of a variant_storage can be emplaced, copied and moved,
+///     independent of the number of types
+TEMPLATE_TEST_CASE("variant_storage types", "[storage]", ManyTypes,
+                   (poly::variant_storage<int, std::string>),
+                   (poly::variant_storage<char, int, long, std::string>),
+                   (poly::variant_storage<char, std::string, int, long,
+                                          std::vector<int>, double>)) {
+  using Storage = TestType;
+  Storage s1;
+  REQUIRE(*s1.template emplace<std::string>("a long string, not in sso") ==
+          "a long string, not in sso");
+  Storage s2(s1);
+  REQUIRE(*static_cast<std::string*>(s2.data()) ==
+          "a long string, not in sso");
+  Storage s3(std::move(s2));
+  REQUIRE(s2.data() == nullptr);
+  REQUIRE(*static_cast<std::string*>(s3.data()) ==
+          "a long string, not in sso");
+
+  s1.template emplace<int>(42);
+  s3 = s1;
+  REQUIRE(*static_cast<int*>(s3.data()) == 42);
+  s1.template emplace<std::string>("other");
+  s3 = std::move(s1);
+  REQUIRE(s1.data() == nullptr);
+  REQUIRE(*static_cast<std::string*>(s3.data()) == "other");
+  s3 = s1;
+  REQUIRE(s3.data() == nullptr);
+}
+
+TEMPLATE_TEST_CASE("cow_storage", "[storage]", poly::cow_storage,
+                   poly::atomic_cow_storage) {
+  using Storage = TestType;
+  using Object = Tracker<64, 16>;
+  int count = 0;
+  SECTION("copies share the object until it is modified") {
+    {
+      Storage s1;
+      const void* addr = s1.template emplace<Object>(count);
+      Storage s2(s1);
+      REQUIRE(std::as_const(s2).data() == addr);
+      REQUIRE(s1.use_count() == 2);
+      REQUIRE(count == 1);
+
+      void* copy = s2.data();
+      REQUIRE(copy != addr);
+      REQUIRE(is_aligned(copy, 16));
+      REQUIRE(count == 2);
+      REQUIRE(s1.use_count() == 1);
+      REQUIRE(s2.use_count() == 1);
+      REQUIRE(s2.data() == copy);
+      REQUIRE(s1.data() == addr);
+      REQUIRE(count == 2);
+    }
+    REQUIRE(count == 0);
+  }
+  SECTION("empty storages stay empty") {
+    Storage s1;
+    Storage s2(s1);
+    REQUIRE(s2.data() == nullptr);
+    REQUIRE(std::as_const(s2).data() == nullptr);
+  }
+}
+
+TEST_CASE("atomic_shared_storage across threads", "[storage]") {
+  std::atomic<int> destroyed{0};
+  struct Counted {
+    std::atomic<int>* destroyed;
+    ~Counted() { ++*destroyed; }
+  };
+  {
+    poly::atomic_shared_storage s;
+    s.emplace<Counted>(Counted{&destroyed});
+    destroyed = 0; // the temporary
+    std::atomic<int> empty_copies{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t != 4; ++t) {
+      threads.emplace_back([s, &empty_copies] {
+        for (int i = 0; i != 10000; ++i) {
+          poly::atomic_shared_storage copy(s);
+          if (copy.data() == nullptr)
+            ++empty_copies;
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    REQUIRE(empty_copies == 0);
+    REQUIRE(s.use_count() == 1);
+    REQUIRE(destroyed == 0);
+  }
+  REQUIRE(destroyed == 1);
+}
@@ -0,0 +1,115 @@
+/**
+ *  Copyright 2024 Pelé Constam
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "poly/task_queue.hpp"
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+  /// task counting its moves, to check that tasks are run where they are
+  /// constructed.
+  struct Counted {
+    Counted(int& runs, int& moves) : runs(&runs), moves(&moves) {}
+    Counted(Counted&& other) noexcept : runs(other.runs), moves(other.moves) {
+      ++*moves;
+    }
+    void operator()() { ++*runs; }
+    int* runs;
+    int* moves;
+  };
+} // namespace
+
+TEST_CASE("task_queue", "[task_queue]") {
+  using Queue = poly::task_queue<4, 32>;
+  STATIC_REQUIRE(Queue::capacity() == 4);
+  Queue queue;
+  REQUIRE(queue.empty());
+  REQUIRE(not queue.try_run());
+
+  SECTION("order") {
+    std::vector<int> order;
+    for (int i = 0; i != 4; ++i)
+      REQUIRE(queue.try_push([&order, i] { order.push_back(i); }));
+    REQUIRE(not queue.try_push([] {}));
+    REQUIRE(queue.run_all() == 4);
+    REQUIRE(order == std::vector<int>{0, 1, 2, 3});
+    REQUIRE(queue.empty());
+
+    // the slots are reused in the next round
+    REQUIRE(queue.try_push([&order] { order.push_back(4); }));
+    REQUIRE(queue.try_run());
+    REQUIRE(order.back() == 4);
+  }
+
+  SECTION("in place construction") {
+    int runs = 0;
+    int moves = 0;
+    REQUIRE(queue.try_emplace<Counted>(runs, moves));
+    REQUIRE(queue.try_run());
+    REQUIRE(runs == 1);
+    REQUIRE(moves == 0);
+  }
+
+  SECTION("move only tasks") {
+    auto value = std::make_unique<int>(1);
+    int result = 0;
+    REQUIRE(queue.try_push(
+        [&result, v = std::move(value)] { result = *v + 1; }));
+    REQUIRE(queue.try_run());
+    REQUIRE(result == 2);
+  }
+
+  SECTION("throwing tasks") {
+    auto resource = std::make_shared<int>(0);
+    REQUIRE(queue.try_push([resource] { throw 1; }));
+    REQUIRE(resource.use_count() == 2);
+    REQUIRE_THROWS_AS(queue.try_run(), int);
+    REQUIRE(resource.use_count() == 1);
+    REQUIRE(queue.empty());
+    for (int i = 0; i != 4; ++i)
+      REQUIRE(queue.try_push([] {}));
+  }
+}
+
+TEST_CASE("task_queue with several producers", "[task_queue]") {
+  constexpr int producers = 4;
+  constexpr int tasks = 10000;
+  poly::task_queue<64, 16> queue;
+  std::atomic<long> sum{0};
+  std::vector<std::thread> threads;
+  for (int p = 0; p != producers; ++p) {
+    threads.emplace_back([&queue, &sum] {
+      for (int i = 1; i <= tasks; ++i) {
+        while (not queue.try_push(
+            [&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); }))
+          std::this_thread::yield();
+      }
+    });
+  }
+  long run = 0;
+  while (run != producers * tasks) {
+    if (queue.try_run())
+      ++run;
+    else
+      std::this_thread::yield();
+  }
+  for (auto& t : threads)
+    t.join();
+  REQUIRE(queue.empty());
+  REQUIRE(sum == producers * (tasks * (tasks + 1L) / 2));
+}